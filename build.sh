@@ -1,4 +1,29 @@
 #!/bin/bash
+#
+# ./build.sh           plain -O2 build
+# ./build.sh release   -O2 with link-time optimization
+# ./build.sh pgo       LTO build trained on a simulated slider/input workload
+# ./build.sh bench     builds plain and PGO binaries and compares them
+# ./build.sh bench-activate   times dmi-activate from launch to a drawn window
+# ./build.sh bench-parse      measures the ddcutil output parsers on generated input
+# ./build.sh check-parse      compares the parsers' results on fuzz/corpus with fuzz/expected
+# ./build.sh fuzz      fuzzes the ddcutil output parsers with libFuzzer (needs clang)
+#
+# Every target except fuzz also builds dmi-activate, the hotkey helper.
+
+set -e
+
+SOURCES="main.c dmi-api.c dmi-sched.c dmi-curve.c dmi-sim.c dmi-stress.c dmi-watchdog.c dmi-state.c dmi-broker.c dmi-quirks.c dmi-control.c dmi-journal.c dmi-sync.c dmi-soak.c dmi-parse.c dmi-backlight.c dmi-async.c"
+LIBS="`pkg-config --cflags --libs gtk4` -lddcutil"
+BASE_FLAGS="-O2 -pipe -fomit-frame-pointer"
+LTO_FLAGS="-flto=auto -fuse-linker-plugin"
+PROFILE_DIR="pgo-data"
+TRAIN_ARGS="--stress=20 --simulate=3 --sim-latency=5 --watchdog=0"
+BENCH_RUNS=5
+BENCH_ARGS="--stress=10 --simulate=3 --watchdog=0"
+ACTIVATE_RUNS=20
+PARSE_LINES=200000
+FUZZ_SECONDS=300
 
 try_flags=(
   "-march=znver4"
@@ -23,4 +48,172 @@ for flag in "${try_flags[@]}"; do
   fi
 done
 
-gcc $ARCH_FLAGS -O2 -pipe -fomit-frame-pointer main.c dmi-api.c -o dmi-gtk `pkg-config --cflags --libs gtk4` -lddcutil
\ No newline at end of file
+# The training and benchmark runs open a window; use a virtual X server when headless
+run_gui() {
+  if [ -z "$DISPLAY" ] && [ -z "$WAYLAND_DISPLAY" ] && command -v xvfb-run >/dev/null; then
+    xvfb-run -a "$@"
+  else
+    "$@"
+  fi
+}
+
+build_plain() {
+  gcc $ARCH_FLAGS $BASE_FLAGS $SOURCES -o "$1" $LIBS
+}
+
+build_release() {
+  gcc $ARCH_FLAGS $BASE_FLAGS $LTO_FLAGS $SOURCES -o "$1" $LIBS
+}
+
+# Includes the GLib headers for the protocol constants but links nothing beyond libc
+build_activate() {
+  gcc $ARCH_FLAGS $BASE_FLAGS `pkg-config --cflags glib-2.0` dmi-activate.c -o dmi-activate
+}
+
+build_pgo() {
+  rm -rf "$PROFILE_DIR"
+  gcc $ARCH_FLAGS $BASE_FLAGS -fprofile-generate -fprofile-update=atomic \
+    -fprofile-dir="$PROFILE_DIR" $SOURCES -o dmi-gtk-train $LIBS
+
+  echo "Training: ./dmi-gtk-train $TRAIN_ARGS"
+  # Instrumented code is slower, so a failed limit here only means a noisy profile
+  run_gui ./dmi-gtk-train $TRAIN_ARGS || echo "Training run reported failures, using profile anyway"
+  rm -f dmi-gtk-train
+
+  gcc $ARCH_FLAGS $BASE_FLAGS $LTO_FLAGS -fprofile-use -fprofile-partial-training \
+    -fprofile-dir="$PROFILE_DIR" -Wno-missing-profile $SOURCES -o "$1" $LIBS
+}
+
+# Prints "<first frame ms> <CPU us per event>" averaged over BENCH_RUNS stress runs
+bench_one() {
+  for i in $(seq $BENCH_RUNS); do
+    run_gui "./$1" $BENCH_ARGS || true
+  done | awk '
+    /first frame/ { start += $4; n++ }
+    /CPU per event/ { cpu += $2 }
+    END { if (n) printf "%.1f %.1f\n", start / n, cpu / n; else print "- -" }'
+}
+
+# Prints min, average and max of the "shown after" times of ACTIVATE_RUNS activations
+bench_activate() {
+  local socket="${XDG_RUNTIME_DIR:-/run/user/$(id -u)}/dmi-gtk-sim.ctl"
+
+  rm -f "$socket"
+  run_gui ./dmi-gtk --simulate=2 --sim-latency=0 --watchdog=0 >/dev/null &
+  local app_pid=$!
+  for i in $(seq 100); do
+    [ -S "$socket" ] && break
+    sleep 0.1
+  done
+
+  ./dmi-activate --sim toggle >/dev/null || true
+  for i in $(seq $ACTIVATE_RUNS); do
+    ./dmi-activate --sim --time activate || true
+    ./dmi-activate --sim toggle >/dev/null || true
+  done | awk '
+    /shown after/ { t = $3; sum += t; n++; if (n == 1 || t < min) min = t; if (t > max) max = t }
+    END { if (n) printf "%.2f %.2f %.2f\n", min, sum / n, max; else print "- - -" }'
+
+  ./dmi-activate --sim quit || true
+  wait $app_pid || true
+}
+
+# Links the parsers alone with the libFuzzer driver; no GTK or ddcutil
+build_fuzz() {
+  clang -g -O1 -fsanitize=fuzzer,address,undefined `pkg-config --cflags glib-2.0` \
+    dmi-fuzz.c dmi-parse.c -o "$1" `pkg-config --libs glib-2.0`
+}
+
+# Writes detect, caps and getvcp samples of PARSE_LINES lines each into directory $1. The caps
+# sample opens with an input list far longer than a line buffer, like the worst real monitors.
+make_parse_input() {
+  awk -v n=$PARSE_LINES 'BEGIN {
+    for (i = 0; i < n / 10; i++) {
+      printf "Display %d\n   I2C bus:  /dev/i2c-%d\n   EDID synopsis:\n", i + 1, i % 64
+      printf "      Mfg id:               DEL - Dell Inc.\n      Model:                DELL U%d\n", i
+      printf "      Product code:         %d\n      Serial number:        SN%08d\n", i, i
+      printf "      Manufacture year:     2021\n   VCP version:         2.1\n\n"
+    }
+  }' > "$1/detect.txt"
+  awk -v n=$PARSE_LINES 'BEGIN {
+    printf "   Feature: 60 (Input Source)\n      Values:"
+    for (i = 0; i < 4096; i++) printf " %02x", i % 256
+    printf " (interpretation unavailable)\n"
+    for (i = 0; i < n; i++) printf "         %02x: Input %d\n", i % 256, i
+  }' > "$1/caps.txt"
+  awk -v n=$PARSE_LINES 'BEGIN {
+    for (i = 0; i < n; i++) {
+      if (i % 2) printf "VCP code 0x60 (Input Source                  ): HDMI-1 (sl=0x11)\n"
+      else printf "VCP code 0x10 (Brightness                    ): current value = %5d, max value =   100\n", i % 101
+    }
+  }' > "$1/getvcp.txt"
+}
+
+case "$1" in
+  ""|plain)
+    build_plain dmi-gtk
+    build_activate
+    ;;
+  release)
+    build_release dmi-gtk
+    build_activate
+    ;;
+  pgo)
+    build_pgo dmi-gtk
+    build_activate
+    ;;
+  bench)
+    build_plain dmi-gtk-plain
+    build_pgo dmi-gtk-pgo
+    read plain_start plain_cpu <<< "$(bench_one dmi-gtk-plain)"
+    read pgo_start pgo_cpu <<< "$(bench_one dmi-gtk-pgo)"
+    printf "%-8s %18s %18s\n" "build" "first frame (ms)" "CPU/event (us)"
+    printf "%-8s %18s %18s\n" "plain" "$plain_start" "$plain_cpu"
+    printf "%-8s %18s %18s\n" "pgo" "$pgo_start" "$pgo_cpu"
+    ;;
+  bench-activate)
+    build_release dmi-gtk
+    build_activate
+    read act_min act_avg act_max <<< "$(bench_activate)"
+    printf "%-10s %10s %10s %10s\n" "activate" "min (ms)" "avg (ms)" "max (ms)"
+    printf "%-10s %10s %10s %10s\n" "to shown" "$act_min" "$act_avg" "$act_max"
+    ;;
+  bench-parse)
+    build_release dmi-gtk
+    parse_dir=$(mktemp -d)
+    make_parse_input "$parse_dir"
+    for kind in detect caps getvcp; do
+      printf "%-8s " "$kind"
+      ./dmi-gtk --parse=$kind < "$parse_dir/$kind.txt" 2>&1 >/dev/null
+    done
+    rm -rf "$parse_dir"
+    ;;
+  check-parse)
+    build_plain dmi-gtk
+    failed=0
+    # The file name's prefix names the parser: detect-*.txt goes through --parse=detect
+    for sample in fuzz/corpus/*.txt; do
+      name=$(basename "$sample")
+      kind=${name%%-*}
+      if ./dmi-gtk --parse=$kind < "$sample" 2>/dev/null | diff -u "fuzz/expected/$name" -; then
+        echo "ok      $name"
+      else
+        echo "FAILED  $name"
+        failed=1
+      fi
+    done
+    exit $failed
+    ;;
+  fuzz)
+    build_fuzz dmi-fuzz
+    # New inputs go to a scratch copy; fuzz/corpus keeps only the hand-picked samples
+    fuzz_dir=$(mktemp -d)
+    cp fuzz/corpus/* "$fuzz_dir"
+    ./dmi-fuzz -max_total_time=$FUZZ_SECONDS -max_len=65536 "$fuzz_dir"
+    rm -rf "$fuzz_dir"
+    ;;
+  *)
+    echo "usage: $0 [plain|release|pgo|bench|bench-activate|bench-parse|check-parse|fuzz]"
+    exit 1
+    ;;
+esac
@@ -0,0 +1,127 @@
+/*
+ * dmi-activate: hotkey helper that shows or toggles the running dmi-gtk window through its
+ * control socket. It links neither GTK nor libddcutil, so it starts in a millisecond or
+ * two. If no real instance is listening it execs dmi-gtk instead.
+ *
+ *   dmi-activate [--sim] [--time] [activate|toggle|quit]
+ */
+#include "dmi-control.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REPLY_TIMEOUT_SEC 10
+
+static double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static int control_connect(const char *socket_name) {
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if (!dir || !*dir) return -1;
+    if (snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/%s", dir, socket_name) >=
+        (int)sizeof(addr.sun_path)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct timeval timeout = {.tv_sec = REPLY_TIMEOUT_SEC};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+/* No instance to talk to: start one, next to this binary if that is where it lives */
+static void exec_app(const char *argv0) {
+    const char *slash = strrchr(argv0, '/');
+    char path[4096];
+
+    if (slash) {
+        snprintf(path, sizeof(path), "%.*s/dmi-gtk", (int)(slash - argv0), argv0);
+    } else {
+        snprintf(path, sizeof(path), "dmi-gtk");
+    }
+
+    execlp(path, path, (char *)NULL);
+    fprintf(stderr, "Failed to start %s: %s\n", path, strerror(errno));
+}
+
+int main(int argc, char **argv) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    const char *command = "toggle";
+    gboolean sim = FALSE;
+    gboolean timing = FALSE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sim") == 0) {
+            sim = TRUE;
+        } else if (strcmp(argv[i], "--time") == 0) {
+            timing = TRUE;
+        } else if (strcmp(argv[i], "activate") == 0 || strcmp(argv[i], "toggle") == 0 ||
+                   strcmp(argv[i], "quit") == 0) {
+            command = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [--sim] [--time] [activate|toggle|quit]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int fd = control_connect(sim ? DMI_CONTROL_SIM_SOCKET : DMI_CONTROL_SOCKET);
+    if (fd < 0) {
+        if (strcmp(command, "quit") == 0) return 0;
+        /* Simulated instances are only started by hand */
+        if (sim) {
+            fprintf(stderr, "No simulated instance is running\n");
+            return 1;
+        }
+        exec_app(argv[0]);
+        return 1;
+    }
+
+    char buf[DMI_CONTROL_MAX_LINE];
+    int len = snprintf(buf, sizeof(buf), "%s\n", command);
+
+    if (write(fd, buf, len) != len) {
+        fprintf(stderr, "Failed to send command: %s\n", strerror(errno));
+        close(fd);
+        return 1;
+    }
+
+    ssize_t n = 0;
+    size_t got = 0;
+    while (got < sizeof(buf) - 1 && (n = read(fd, buf + got, sizeof(buf) - 1 - got)) > 0) {
+        got += n;
+        if (memchr(buf, '\n', got)) break;
+    }
+    close(fd);
+
+    buf[got] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+
+    if (got == 0) {
+        fprintf(stderr, "No reply from dmi-gtk\n");
+        return 1;
+    }
+
+    if (timing) printf("%s after %.2f ms\n", buf, elapsed_ms(&start));
+    return strcmp(buf, "error") == 0 ? 1 : 0;
+}
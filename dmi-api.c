@@ -1,5 +1,14 @@
 #include "dmi-api.h"
-
+#include "dmi-backend.h"
+#include "dmi-backlight.h"
+#include "dmi-journal.h"
+#include "dmi-parse.h"
+#include "dmi-quirks.h"
+#include "dmi-sched.h"
+#include "dmi-watchdog.h"
+
+#include <ddcutil_status_codes.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,13 +16,25 @@
 #define VCP_BRIGHTNESS 0x10
 #define VCP_CONTRAST 0x12
 #define VCP_CTEMP 0x14
+#define VCP_RED_GAIN 0x16
+#define VCP_GREEN_GAIN 0x18
+#define VCP_BLUE_GAIN 0x1A
 #define VCP_VOL 0x62
 #define VCP_INPUT 0x60
 
-#define MAX_DISPLAYS 10
-#define MAX_LINE_LEN 512
 #define DEBUG_MODE 0
 
+#define DMI_TIMEOUT_GET_MS 2000
+#define DMI_TIMEOUT_SET_MS 2000
+#define DMI_TIMEOUT_INPUT_MS 5000
+#define DMI_TIMEOUT_CAPS_MS 10000
+#define DMI_TIMEOUT_DETECT_MS 30000
+#define CALL_POOL_IDLE_MS 10000
+#define MAX_PLAUSIBLE 1000
+#define BREAKER_THRESHOLD 3
+#define BREAKER_BACKOFF_MIN_SEC 30
+#define BREAKER_BACKOFF_MAX_SEC 3600
+
 #if DEBUG_MODE
 #define DEBUG_PRINT(fmt, ...) g_print("[DMI-API] " fmt, ##__VA_ARGS__)
 #else
@@ -36,456 +57,1287 @@ const InputSource known_inputs[] = {
 
 const size_t known_inputs_count = sizeof(known_inputs) / sizeof(known_inputs[0]);
 
-typedef struct {
-    char model_name[64];
-    char mfg_id[32];
-    int bus_number;
-} BusInfo;
+static GHashTable *get_all_display_bus_numbers(gint64 deadline, GCancellable *cancellable);
+static int find_bus_for_display(GHashTable *bus_index, const DDCA_Display_Info *info);
+
+/*
+ * Bounded calls: the blocking ddcutil work runs on a pool thread while the caller waits on
+ * a condition variable until the work finishes, the deadline passes or the cancellable
+ * fires. The call state is shared and refcounted, so a caller that gives up simply drops
+ * its reference and the worker frees everything once the stuck I/O eventually returns.
+ */
+typedef struct _BoundedCall BoundedCall;
+typedef void (*BoundedWorkFunc)(BoundedCall *bc);
+
+struct _BoundedCall {
+    gint ref;
+    GMutex lock;
+    GCond cond;
+    gboolean done;
+    /* The caller timed out first; counted in disp->io_abandoned until the worker is done */
+    gboolean abandoned;
+    BoundedWorkFunc work;
+    GDestroyNotify abandon;
+
+    dmi_display *disp;
+    guint8 code;
+    guint16 value;
+    guint16 cur;
+    guint16 max;
+    const char *op;
+    gint64 deadline;
+    GCancellable *cancellable;
+    gboolean wait;
+    gpointer result;
+    int rc;
+    dmi_vcp_write *writes;
+    guint n_writes;
+};
+
+static GThreadPool *call_pool = NULL;
+static GOnce call_pool_once = G_ONCE_INIT;
+
+static dmi_display *display_ref(dmi_display *disp) {
+    g_atomic_int_inc(&disp->ref);
+    return disp;
+}
+
+static void display_unref(dmi_display *disp) {
+    if (!g_atomic_int_dec_and_test(&disp->ref)) return;
+
+    if (disp->backend && disp->backend->close) disp->backend->close(disp);
+    if (disp->supported_inputs) g_array_free(disp->supported_inputs, TRUE);
+    g_mutex_clear(&disp->io_lock);
+    g_mutex_clear(&disp->cache_lock);
+    g_mutex_clear(&disp->health_lock);
+    g_free(disp);
+}
+
+static void bounded_call_unref(BoundedCall *bc) {
+    if (!g_atomic_int_dec_and_test(&bc->ref)) return;
+
+    if (bc->disp) display_unref(bc->disp);
+    if (bc->abandon && bc->result) bc->abandon(bc->result);
+    g_clear_object(&bc->cancellable);
+    g_free(bc->writes);
+    g_mutex_clear(&bc->lock);
+    g_cond_clear(&bc->cond);
+    g_free(bc);
+}
+
+/* Failures of the handle rather than of the feature: the monitor was power cycled or switched
+ * away from our input and back, and the handle opened at startup no longer reaches it */
+static gboolean handle_lost(int rc) {
+    switch (rc) {
+    case DMI_STATUS_DISCONNECTED:
+    case DDCRC_INVALID_DISPLAY:
+#ifdef DDCRC_DISCONNECTED
+    case DDCRC_DISCONNECTED:
+#endif
+    case -EBADF:
+    case -ENODEV:
+    case -ENXIO:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/* Called with io_lock held, so no other command races the new handle */
+static gboolean display_reopen(dmi_display *disp, int rc) {
+    if (!disp->backend->reopen) return FALSE;
+
+    g_atomic_int_set(&disp->handle_stale, FALSE);
+    int reopen_rc = disp->backend->reopen(disp);
+    if (reopen_rc != 0) {
+        g_printerr("%s: display handle lost (%d), reopening failed: %d\n", disp->info.model_name,
+                   rc, reopen_rc);
+        return FALSE;
+    }
+
+    g_print("%s: display handle lost (%d), reopened\n", disp->info.model_name, rc);
+    return TRUE;
+}
+
+/* Called with io_lock held */
+static void bounded_call_io(BoundedCall *bc) {
+    dmi_display *disp = bc->disp;
+    guint spacing_ms = disp->quirk ? disp->quirk->spacing_ms : 0;
+
+    if (spacing_ms > 0) {
+        gint64 wait = disp->last_io_us + spacing_ms * G_TIME_SPAN_MILLISECOND -
+                      g_get_monotonic_time();
+        if (wait > 0) g_usleep(wait);
+    }
+    if (g_atomic_int_get(&disp->handle_stale)) display_reopen(disp, DMI_STATUS_DISCONNECTED);
+
+    disp->io_deadline = bc->deadline;
+    disp->io_cancellable = bc->cancellable;
+    bc->work(bc);
+    /* Once: a handle that fails again straight after reopening is not coming back yet */
+    if (handle_lost(bc->rc) && display_reopen(disp, bc->rc)) bc->work(bc);
+    disp->io_deadline = 0;
+    disp->io_cancellable = NULL;
+
+    if (spacing_ms > 0) disp->last_io_us = g_get_monotonic_time();
+}
+
+static void bounded_call_worker(gpointer data, gpointer user_data) {
+    BoundedCall *bc = data;
+
+    /* Skip the bus entirely if the caller already gave up while this call was queued, both
+     * before waiting for the display and again once it is ours */
+    if (!bc->disp) {
+        if (g_atomic_int_get(&bc->ref) > 1) bc->work(bc);
+    } else if (g_atomic_int_get(&bc->ref) > 1) {
+        g_mutex_lock(&bc->disp->io_lock);
+        if (g_atomic_int_get(&bc->ref) > 1) bounded_call_io(bc);
+        g_mutex_unlock(&bc->disp->io_lock);
+    }
+
+    g_mutex_lock(&bc->lock);
+    bc->done = TRUE;
+    if (bc->abandoned) g_atomic_int_add(&bc->disp->io_abandoned, -1);
+    g_cond_broadcast(&bc->cond);
+    g_mutex_unlock(&bc->lock);
+
+    bounded_call_unref(bc);
+}
+
+static gpointer call_pool_create(gpointer data) {
+    /* Non-exclusive and unbounded, so a worker stuck on a dead bus never starves calls on
+     * other displays; the dead display itself stops taking workers once a call times out */
+    GThreadPool *pool = g_thread_pool_new(bounded_call_worker, NULL, -1, FALSE, NULL);
+    g_thread_pool_set_max_idle_time(CALL_POOL_IDLE_MS);
+    return pool;
+}
+
+static void bounded_call_cancelled(GCancellable *cancellable, gpointer data) {
+    BoundedCall *bc = data;
+
+    g_mutex_lock(&bc->lock);
+    g_cond_broadcast(&bc->cond);
+    g_mutex_unlock(&bc->lock);
+}
+
+static BoundedCall *bounded_call_new(const char *op, dmi_display *disp, BoundedWorkFunc work) {
+    BoundedCall *bc = g_new0(BoundedCall, 1);
+    bc->op = op;
+    bc->ref = 1;
+    g_mutex_init(&bc->lock);
+    g_cond_init(&bc->cond);
+    bc->work = work;
+    /* Kept alive for a worker that outlives its caller and the display list */
+    bc->disp = disp ? display_ref(disp) : NULL;
+    bc->rc = DMI_STATUS_ERROR;
+    return bc;
+}
+
+static int bounded_call_run(BoundedCall *bc, const dmi_call *call, gint64 default_timeout_ms) {
+    GCancellable *cancellable = call ? call->cancellable : NULL;
+    if (g_cancellable_is_cancelled(cancellable)) return DMI_STATUS_CANCELLED;
+
+    gint64 deadline = (call && call->deadline > 0)
+                          ? call->deadline
+                          : g_get_monotonic_time() + default_timeout_ms * G_TIME_SPAN_MILLISECOND;
+
+    /* A display still busy with a call nobody waits for any more would only tie up another
+     * pool thread on io_lock */
+    if (bc->disp && g_atomic_int_get(&bc->disp->io_abandoned) > 0) {
+        DEBUG_PRINT("%s: display still stuck, failing fast\n", bc->op);
+        return DMI_STATUS_BUSY;
+    }
+
+    call_pool = g_once(&call_pool_once, call_pool_create, NULL);
+
+    /* Helper processes spawned by the work are killed by the same limits */
+    bc->deadline = deadline;
+    if (cancellable) bc->cancellable = g_object_ref(cancellable);
+
+    g_atomic_int_inc(&bc->ref);
+    g_thread_pool_push(call_pool, bc, NULL);
+    dmi_watchdog_op_begin(bc->op, bc->disp, bc->code);
+
+    gulong handler = 0;
+    if (cancellable) {
+        handler = g_cancellable_connect(cancellable, G_CALLBACK(bounded_call_cancelled), bc, NULL);
+    }
+
+    int status = 0;
+    g_mutex_lock(&bc->lock);
+    while (!bc->done) {
+        if (g_cancellable_is_cancelled(cancellable)) {
+            status = DMI_STATUS_CANCELLED;
+            break;
+        }
+        if (!g_cond_wait_until(&bc->cond, &bc->lock, deadline) && !bc->done) {
+            status = DMI_STATUS_TIMEOUT;
+            break;
+        }
+    }
+    if (status == DMI_STATUS_TIMEOUT && bc->disp) {
+        bc->abandoned = TRUE;
+        g_atomic_int_inc(&bc->disp->io_abandoned);
+    }
+    g_mutex_unlock(&bc->lock);
+    dmi_watchdog_op_end();
+
+    if (cancellable) {
+        g_cancellable_disconnect(cancellable, handler);
+    }
+
+    if (status == DMI_STATUS_TIMEOUT) {
+        g_printerr("WARNING: %s timed out\n", bc->op);
+    }
 
-static int get_all_display_bus_numbers(BusInfo **bus_info_array);
-static int find_bus_for_display(BusInfo *bus_info_array, int count, const char *model_name,
-                                const char *mfg_id);
-static void free_bus_info_array(BusInfo *array);
+    return status;
+}
 
-int dmi_display_get_brightness(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
+static int ddc_get_vcp(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max) {
+    if (!disp->dh) return DMI_STATUS_DISCONNECTED;
 
     DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status ddcrc = ddca_get_non_table_vcp_value(disp->dh, VCP_BRIGHTNESS, &valrec);
+    DDCA_Status ddcrc = ddca_get_non_table_vcp_value(disp->dh, code, &valrec);
+
+    if (ddcrc == 0) {
+        *cur = (valrec.sh << 8) | valrec.sl;
+        *max = (valrec.mh << 8) | valrec.ml;
+    }
+    return ddcrc;
+}
+
+/* ddcutil's own verification is switched off at startup because the switch is process-wide;
+ * writes that want it read the value back here instead */
+static int ddc_verify(dmi_display *disp, guint8 code, guint16 value) {
+    guint16 cur, max;
+    int rc = ddc_get_vcp(disp, code, &cur, &max);
+
+    if (rc == 0 && cur != value) rc = DDCRC_VERIFY;
+    return rc;
+}
+
+static int ddc_set_vcp(dmi_display *disp, guint8 code, guint16 value) {
+    if (!disp->dh) return DMI_STATUS_DISCONNECTED;
+
+    guint8 high = value >> 8;
+    guint8 low = value & 0xFF;
+
+    DDCA_Status ddcrc = ddca_set_non_table_vcp_value(disp->dh, code, high, low);
+
+    /* Input and power changes make the monitor drop off the bus for a while, so reading the
+     * value back would only burn retries */
+    if (ddcrc == 0 && code != VCP_INPUT && code != 0xAC && code != 0xAA) {
+        ddcrc = ddc_verify(disp, code, value);
+    }
+    return ddcrc;
+}
+
+int dmi_vcp_write_spaced(dmi_display *disp, const dmi_vcp_write *writes, guint n) {
+    guint spacing_ms = MAX(DMI_BATCH_SPACING_MS, disp->quirk ? disp->quirk->spacing_ms : 0);
+    gint64 last = 0;
+
+    for (guint i = 0; i < n; i++) {
+        if (i > 0) {
+            gint64 wait = last + spacing_ms * G_TIME_SPAN_MILLISECOND - g_get_monotonic_time();
+            if (wait > 0) g_usleep(wait);
+        }
+
+        last = g_get_monotonic_time();
+        int rc = disp->backend->set_vcp(disp, writes[i].code, writes[i].value);
+        dmi_journal_record(disp, DMI_JOURNAL_SET, writes[i].code, writes[i].value, 0, rc, last);
+        if (rc != 0) return rc;
+    }
+    return 0;
+}
+
+static int ddc_set_vcp_batch(dmi_display *disp, const dmi_vcp_write *writes, guint n) {
+    if (!disp->dh) return DMI_STATUS_DISCONNECTED;
+
+    /* Read back only once every write is out, so the spacing between writes stays short */
+    int rc = dmi_vcp_write_spaced(disp, writes, n);
+    for (guint i = 0; i < n && rc == 0; i++) {
+        rc = ddc_verify(disp, writes[i].code, writes[i].value);
+    }
+    return rc;
+}
+
+typedef struct {
+    GBytes *out;
+    GError *error;
+    gboolean finished;
+} CommandRun;
+
+static void command_done(GObject *source, GAsyncResult *result, gpointer data) {
+    CommandRun *run = data;
+
+    g_subprocess_communicate_finish(G_SUBPROCESS(source), result, &run->out, NULL, &run->error);
+    run->finished = TRUE;
+}
+
+static gboolean command_expired(gpointer data) {
+    g_cancellable_cancel(data);
+    return G_SOURCE_REMOVE;
+}
+
+static void command_cancelled(GCancellable *cancellable, gpointer data) {
+    g_cancellable_cancel(data);
+}
+
+/*
+ * Runs a ddcutil command line to completion on the calling pool worker and opens its output
+ * for the line parsers. The child is killed once the deadline passes or the caller's
+ * cancellable fires, so a hung ddcutil cannot keep io_lock. Returns NULL with *rc set when
+ * the command did not finish; otherwise close with command_close().
+ */
+static FILE *command_open(const char *const *argv, gint64 deadline, GCancellable *cancellable,
+                          GBytes **out, int *rc) {
+    GError *error = NULL;
+    GSubprocess *proc = g_subprocess_newv(
+        argv, G_SUBPROCESS_FLAGS_STDOUT_PIPE | G_SUBPROCESS_FLAGS_STDERR_SILENCE, &error);
+    if (!proc) {
+        DEBUG_PRINT("Cannot run %s: %s\n", argv[0], error->message);
+        g_error_free(error);
+        *rc = DMI_STATUS_ERROR;
+        return NULL;
+    }
+
+    /* The worker has no main loop of its own, so the wait runs in a private context */
+    GMainContext *context = g_main_context_new();
+    g_main_context_push_thread_default(context);
+
+    GCancellable *kill = g_cancellable_new();
+    gulong handler = cancellable ? g_cancellable_connect(cancellable,
+                                                         G_CALLBACK(command_cancelled), kill, NULL)
+                                 : 0;
+    gint64 remaining_ms = MAX(0, deadline - g_get_monotonic_time()) / G_TIME_SPAN_MILLISECOND;
+    GSource *timer = g_timeout_source_new(remaining_ms);
+    g_source_set_callback(timer, command_expired, kill, NULL);
+    g_source_attach(timer, context);
+
+    CommandRun run = {0};
+    g_subprocess_communicate_async(proc, NULL, kill, command_done, &run);
+    while (!run.finished) g_main_context_iteration(context, TRUE);
+
+    g_source_destroy(timer);
+    g_source_unref(timer);
+    if (cancellable) g_cancellable_disconnect(cancellable, handler);
+
+    if (run.error) {
+        if (g_cancellable_is_cancelled(cancellable)) {
+            *rc = DMI_STATUS_CANCELLED;
+        } else if (g_cancellable_is_cancelled(kill)) {
+            g_printerr("WARNING: ddcutil %s did not finish in time, killed\n", argv[1]);
+            *rc = DMI_STATUS_TIMEOUT;
+        } else {
+            *rc = DMI_STATUS_ERROR;
+        }
+        g_subprocess_force_exit(proc);
+        g_error_free(run.error);
+    }
+
+    g_object_unref(kill);
+    g_object_unref(proc);
+    g_main_context_pop_thread_default(context);
+    g_main_context_unref(context);
+
+    if (!run.out) return NULL;
+
+    /* fmemopen rejects an empty buffer; no output parses like an empty file */
+    gsize size;
+    gconstpointer data = g_bytes_get_data(run.out, &size);
+    FILE *fp = fmemopen((void *)(size ? data : "\n"), size ? size : 1, "r");
+    if (!fp) {
+        g_bytes_unref(run.out);
+        *rc = DMI_STATUS_ERROR;
+        return NULL;
+    }
+
+    *out = run.out;
+    return fp;
+}
+
+static void command_close(FILE *fp, GBytes *out) {
+    fclose(fp);
+    g_bytes_unref(out);
+}
+
+static int ddc_getvcp_command(dmi_display *disp, guint8 code, guint16 *value) {
+    if (disp->i2c_busno < 0) return DMI_STATUS_ERROR;
+
+    char code_arg[8], bus_arg[32];
+    snprintf(code_arg, sizeof(code_arg), "%02x", code);
+    snprintf(bus_arg, sizeof(bus_arg), "--bus=%d", disp->i2c_busno);
+    const char *argv[] = {"ddcutil", "getvcp", code_arg, bus_arg, NULL};
+
+    GBytes *out;
+    int rc;
+    FILE *fp = command_open(argv, disp->io_deadline, disp->io_cancellable, &out, &rc);
+    if (!fp) return rc;
+
+    char line[DMI_PARSE_LINE_MAX];
+    int parsed = -1;
+
+    while (parsed < 0 && dmi_parse_read_line(fp, line, sizeof(line))) {
+        parsed = dmi_parse_getvcp(line);
+    }
+
+    command_close(fp, out);
+    DEBUG_PRINT("VCP 0x%02x: 0x%02x (via command)\n", code, parsed);
+
+    if (parsed < 0) return DMI_STATUS_ERROR;
+    *value = parsed;
+    return 0;
+}
+
+static int ddc_get_inputs(dmi_display *disp, GArray *supported) {
+    if (disp->i2c_busno < 0) return DMI_STATUS_ERROR;
+
+    char bus_arg[32];
+    snprintf(bus_arg, sizeof(bus_arg), "--bus=%d", disp->i2c_busno);
+    const char *argv[] = {"ddcutil", "capabilities", bus_arg, NULL};
+
+    GBytes *out;
+    int rc;
+    FILE *fp = command_open(argv, disp->io_deadline, disp->io_cancellable, &out, &rc);
+    if (!fp) return rc;
+
+    char line[DMI_PARSE_LINE_MAX];
+    dmi_parse_caps state = {0};
+    int codes[16];
+
+    while (!state.done && dmi_parse_read_line(fp, line, sizeof(line))) {
+        guint n = dmi_parse_caps_inputs(&state, line, codes, G_N_ELEMENTS(codes));
+        for (guint i = 0; i < n; i++) {
+            dmi_inputs_add_code(disp, supported, codes[i]);
+        }
+    }
+
+    command_close(fp, out);
+    return 0;
+}
+
+static void ddc_close(dmi_display *disp) {
+    if (disp->dh) {
+        ddca_close_display(disp->dh);
+        disp->dh = NULL;
+    }
+}
+
+/* Looked up again by bus number, since ddcutil hands out a new reference for a display
+ * that went away and came back; info keeps the original so the identity stays the same */
+static int ddc_reopen(dmi_display *disp) {
+    ddc_close(disp);
+
+    DDCA_Display_Ref dref = disp->info.dref;
+#if DDCUTIL_VMAJOR >= 2
+    DDCA_Display_Identifier did;
+    if (disp->i2c_busno >= 0 && ddca_create_busno_display_identifier(disp->i2c_busno, &did) == 0) {
+        DDCA_Display_Ref found;
+        if (ddca_get_display_ref(did, &found) == 0) dref = found;
+        ddca_free_display_identifier(did);
+    }
+#endif
+
+    DDCA_Status rc = ddca_open_display2(dref, FALSE, &disp->dh);
+    if (rc != 0) disp->dh = NULL;
+    return rc;
+}
+
+static const dmi_backend ddc_backend = {
+    .name = "ddc",
+    .get_vcp = ddc_get_vcp,
+    .set_vcp = ddc_set_vcp,
+    .set_vcp_batch = ddc_set_vcp_batch,
+    .get_inputs = ddc_get_inputs,
+    .close = ddc_close,
+    .reopen = ddc_reopen,
+};
+
+void dmi_inputs_add_code(dmi_display *disp, GArray *supported, int code) {
+    code = dmi_quirk_input_from_monitor(disp->quirk, code);
+
+    for (guint i = 0; i < known_inputs_count; i++) {
+        if (known_inputs[i].code == code) {
+            g_array_append_val(supported, i);
+            DEBUG_PRINT("Display supports input: 0x%02x (%s)\n", code, known_inputs[i].name);
+            return;
+        }
+    }
+}
+
+static void vcp_get_work(BoundedCall *bc) {
+    gint64 start = g_get_monotonic_time();
+
+    bc->rc = bc->disp->backend->get_vcp(bc->disp, bc->code, &bc->cur, &bc->max);
+    dmi_journal_record(bc->disp, DMI_JOURNAL_GET, bc->code, bc->cur, bc->max, bc->rc, start);
+}
+
+static void vcp_set_work(BoundedCall *bc) {
+    gint64 start = g_get_monotonic_time();
+
+    bc->rc = bc->disp->backend->set_vcp(bc->disp, bc->code, bc->value);
+    dmi_journal_record(bc->disp, DMI_JOURNAL_SET, bc->code, bc->value, 0, bc->rc, start);
+}
+
+static void vcp_batch_work(BoundedCall *bc) {
+    const dmi_backend *backend = bc->disp->backend;
+
+    if (backend->set_vcp_batch) {
+        bc->rc = backend->set_vcp_batch(bc->disp, bc->writes, bc->n_writes);
+    } else {
+        bc->rc = dmi_vcp_write_spaced(bc->disp, bc->writes, bc->n_writes);
+    }
+}
+
+static void getvcp_command_work(BoundedCall *bc) {
+    gint64 start = g_get_monotonic_time();
+
+    bc->rc = bc->disp->backend->get_vcp(bc->disp, bc->code, &bc->cur, &bc->max);
+
+    if (bc->rc == 0) {
+        bc->cur &= 0xFF;
+        DEBUG_PRINT("VCP 0x%02x: 0x%02x (via %s)\n", bc->code, bc->cur, bc->disp->backend->name);
+    } else if (bc->disp->backend == &ddc_backend && !handle_lost(bc->rc)) {
+        /* Only for features the library cannot read; a lost handle is reopened instead */
+        bc->rc = ddc_getvcp_command(bc->disp, bc->code, &bc->cur);
+    }
+
+    dmi_journal_record(bc->disp, DMI_JOURNAL_GET, bc->code, bc->cur, bc->max, bc->rc, start);
+}
+
+static dmi_value_observer value_observer = NULL;
+static gpointer value_observer_data = NULL;
+
+void dmi_set_value_observer(dmi_value_observer observer, gpointer user_data) {
+    value_observer_data = user_data;
+    value_observer = observer;
+}
+
+static void display_notify(dmi_display *disp, guint8 code) {
+    if (value_observer) value_observer(disp, code, value_observer_data);
+}
+
+/* Writers hold cache_lock, so the sequence only has to order them against readers */
+static void cache_write_begin(dmi_display *disp) {
+    g_mutex_lock(&disp->cache_lock);
+    __atomic_store_n(&disp->cache_seq, disp->cache_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void cache_write_end(dmi_display *disp) {
+    __atomic_store_n(&disp->cache_seq, disp->cache_seq + 1, __ATOMIC_RELEASE);
+    g_mutex_unlock(&disp->cache_lock);
+}
+
+static guint16 *cache_field(dmi_display_values *v, guint8 code, guint16 **max) {
+    switch (code) {
+    case VCP_BRIGHTNESS:
+        *max = &v->brightness_max;
+        return &v->brightness_val;
+    case VCP_CONTRAST:
+        *max = &v->contrast_max;
+        return &v->contrast_val;
+    case VCP_CTEMP:
+        *max = &v->ctemp_max;
+        return &v->ctemp_val;
+    case VCP_RED_GAIN:
+        *max = &v->red_gain_max;
+        return &v->red_gain_val;
+    case VCP_GREEN_GAIN:
+        *max = &v->green_gain_max;
+        return &v->green_gain_val;
+    case VCP_BLUE_GAIN:
+        *max = &v->blue_gain_max;
+        return &v->blue_gain_val;
+    case VCP_VOL:
+        *max = &v->volume_max;
+        return &v->volume_val;
+    default:
+        return NULL;
+    }
+}
+
+/* Call between cache_write_begin and _end; max is left alone when NULL */
+static gboolean cache_put(dmi_display *disp, guint8 code, guint16 value, const guint16 *max) {
+    if (code == VCP_INPUT) {
+        disp->cache.input_val = dmi_quirk_input_from_monitor(disp->quirk, value & 0xFF);
+        return TRUE;
+    }
+
+    guint16 *cached_max;
+    guint16 *cached = cache_field(&disp->cache, code, &cached_max);
+    if (!cached) return FALSE;
+
+    *cached = value;
+    if (max) *cached_max = *max;
+    return TRUE;
+}
+
+/* Keeps the per-display value cache in step with every value read or written */
+static void display_cache_store(dmi_display *disp, guint8 code, guint16 value) {
+    cache_write_begin(disp);
+    gboolean stored = cache_put(disp, code, value, NULL);
+    cache_write_end(disp);
+
+    if (stored) display_notify(disp, code);
+}
+
+void dmi_display_cache_store(dmi_display *disp, guint8 code, guint16 value, guint16 max) {
+    cache_write_begin(disp);
+    gboolean stored = cache_put(disp, code, value, &max);
+    cache_write_end(disp);
+
+    if (stored) display_notify(disp, code);
+}
+
+void dmi_display_forget(dmi_display *disp, guint8 code) {
+    if (disp) dmi_display_cache_store(disp, code, 0, 0);
+}
+
+void dmi_display_snapshot(const dmi_display *disp, dmi_display_values *out) {
+    for (;;) {
+        guint before = __atomic_load_n(&disp->cache_seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            g_thread_yield();
+            continue;
+        }
+
+        *out = disp->cache;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&disp->cache_seq, __ATOMIC_RELAXED) == before) return;
+    }
+}
+
+gboolean dmi_display_cached_vcp(const dmi_display *disp, guint8 code, guint16 *cur,
+                                guint16 *max) {
+    dmi_display_values v;
+    guint16 *v_max;
+
+    dmi_display_snapshot(disp, &v);
+    guint16 *v_cur = cache_field(&v, code, &v_max);
+    if (!v_cur) return FALSE;
+
+    *cur = *v_cur;
+    *max = *v_max;
+    return TRUE;
+}
+
+static gint64 breaker_backoff_us(guint trips) {
+    gint64 sec = (gint64)BREAKER_BACKOFF_MIN_SEC << MIN(trips, 7);
+    return MIN(sec, BREAKER_BACKOFF_MAX_SEC) * G_USEC_PER_SEC;
+}
+
+/* FALSE while the breaker is open. The first caller after the backoff becomes the probe and
+ * pushes the deadline out again, so a dead feature gets one attempt per backoff. */
+static gboolean breaker_allow(dmi_display *disp, dmi_feature_health *h) {
+    gboolean allow = TRUE;
+
+    g_mutex_lock(&disp->health_lock);
+    if (h->open_until > 0) {
+        gint64 now = g_get_monotonic_time();
+        if (now < h->open_until) {
+            allow = FALSE;
+        } else {
+            h->open_until = now + breaker_backoff_us(h->trips);
+        }
+    }
+    g_mutex_unlock(&disp->health_lock);
+    return allow;
+}
+
+static void breaker_record(dmi_display *disp, dmi_feature_health *h, const char *what, int rc) {
+    gint64 backoff = 0;
+
+    /* A caller giving up, or a call that never reached the bus, says nothing about the
+     * feature */
+    if (rc == DMI_STATUS_CANCELLED || rc == DMI_STATUS_BUSY) return;
+
+    g_mutex_lock(&disp->health_lock);
+    if (rc == 0) {
+        *h = (dmi_feature_health){0};
+    } else {
+        if (h->failures < G_MAXUINT8) h->failures++;
+        if (h->failures >= BREAKER_THRESHOLD) {
+            backoff = breaker_backoff_us(h->trips);
+            h->open_until = g_get_monotonic_time() + backoff;
+            if (h->trips < G_MAXUINT8) h->trips++;
+        }
+    }
+    g_mutex_unlock(&disp->health_lock);
+
+    if (backoff > 0) {
+        g_printerr("%s: %s keeps failing (%d), not trying again for %" G_GINT64_FORMAT " s\n",
+                   disp->info.model_name, what, rc, backoff / G_USEC_PER_SEC);
+    }
+}
+
+static void breaker_record_vcp(dmi_display *disp, guint8 code, int rc) {
+    char what[16];
+    snprintf(what, sizeof(what), "VCP 0x%02x", code);
+    breaker_record(disp, &disp->health[code], what, rc);
+}
+
+void dmi_display_reset_health(dmi_display *disp) {
+    if (!disp) return;
+
+    g_mutex_lock(&disp->health_lock);
+    memset(disp->health, 0, sizeof(disp->health));
+    disp->caps_health = (dmi_feature_health){0};
+    g_mutex_unlock(&disp->health_lock);
+}
+
+/* need_max: a maximum of 0 or above MAX_PLAUSIBLE is junk and counts as a failure */
+static int dmi_vcp_get(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max,
+                       gboolean need_max, const dmi_call *call) {
+    if (!disp || !disp->backend) return DMI_STATUS_ERROR;
+    if (dmi_quirk_unsupported(disp->quirk, code)) return DDCRC_REPORTED_UNSUPPORTED;
+    if (!breaker_allow(disp, &disp->health[code])) return DMI_STATUS_UNAVAILABLE;
+
+    BoundedCall *bc = bounded_call_new("getvcp", disp, vcp_get_work);
+    bc->code = code;
+
+    int rc = bounded_call_run(bc, call, DMI_TIMEOUT_GET_MS);
+    guint16 reported_max = 0;
+    if (rc == 0) {
+        rc = bc->rc;
+        if (rc == 0) {
+            reported_max = dmi_quirk_max(disp->quirk, code, bc->max);
+            *cur = bc->cur;
+            if (max) *max = reported_max;
+        }
+    }
+
+    gboolean junk = need_max && rc == 0 && (reported_max == 0 || reported_max > MAX_PLAUSIBLE);
+    breaker_record_vcp(disp, code, junk ? DMI_STATUS_ERROR : rc);
+
+    bounded_call_unref(bc);
+    return rc;
+}
+
+static int dmi_vcp_set(dmi_display *disp, guint8 code, guint16 value, const dmi_call *call,
+                       gint64 default_timeout_ms) {
+    if (!disp || !disp->backend) return DMI_STATUS_ERROR;
+    if (dmi_quirk_unsupported(disp->quirk, code)) return DDCRC_REPORTED_UNSUPPORTED;
+    if (!breaker_allow(disp, &disp->health[code])) return DMI_STATUS_UNAVAILABLE;
+
+    BoundedCall *bc = bounded_call_new("setvcp", disp, vcp_set_work);
+    bc->code = code;
+    bc->value = value;
+
+    int rc = bounded_call_run(bc, call, default_timeout_ms);
+    if (rc == 0) rc = bc->rc;
+    if (rc == 0) display_cache_store(disp, code, value);
+    breaker_record_vcp(disp, code, rc);
+
+    bounded_call_unref(bc);
+    return rc;
+}
+
+int dmi_display_get_brightness(dmi_display *disp, const dmi_call *call) {
+    guint16 current, maximum;
+    int ddcrc = dmi_vcp_get(disp, VCP_BRIGHTNESS, &current, &maximum, FALSE, call);
 
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to get brightness: %d\n", ddcrc);
         return ddcrc;
     }
 
-    disp->brightness_val = (valrec.sh << 8) | valrec.sl;
-    disp->brightness_max = (valrec.mh << 8) | valrec.ml;
+    dmi_display_cache_store(disp, VCP_BRIGHTNESS, current, maximum);
 
-    DEBUG_PRINT("Brightness: %d/%d\n", disp->brightness_val, disp->brightness_max);
+    DEBUG_PRINT("Brightness: %d/%d\n", current, maximum);
     return 0;
 }
 
-int dmi_display_set_brightness(dmi_display *disp, guint16 new_val) {
-    if (!disp || !disp->dh) return -1;
-    if (new_val > disp->brightness_max) return -1;
+int dmi_display_set_brightness(dmi_display *disp, guint16 new_val, const dmi_call *call) {
+    if (!disp || !disp->backend) return -1;
 
-    guint8 high = new_val >> 8;
-    guint8 low = new_val & 0xFF;
+    guint16 cur, max;
+    dmi_display_cached_vcp(disp, VCP_BRIGHTNESS, &cur, &max);
+    if (new_val > max) return -1;
 
-    DDCA_Status ddcrc = ddca_set_non_table_vcp_value(disp->dh, VCP_BRIGHTNESS, high, low);
+    int ddcrc = dmi_vcp_set(disp, VCP_BRIGHTNESS, new_val, call, DMI_TIMEOUT_SET_MS);
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to set brightness: %d\n", ddcrc);
         return ddcrc;
     }
 
-    disp->brightness_val = new_val;
     return 0;
 }
 
-int dmi_display_get_contrast(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
-
-    DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status ddcrc = ddca_get_non_table_vcp_value(disp->dh, VCP_CONTRAST, &valrec);
+int dmi_display_get_contrast(dmi_display *disp, const dmi_call *call) {
+    guint16 current, maximum;
+    int ddcrc = dmi_vcp_get(disp, VCP_CONTRAST, &current, &maximum, TRUE, call);
 
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to get contrast: %d\n", ddcrc);
         return ddcrc;
     }
 
-    guint16 current = (valrec.sh << 8) | valrec.sl;
-    guint16 maximum = (valrec.mh << 8) | valrec.ml;
-
-    if (maximum == 0 || maximum > 1000) {
+    if (maximum == 0 || maximum > MAX_PLAUSIBLE) {
         DEBUG_PRINT("Invalid contrast max value: %d\n", maximum);
         return -1;
     }
 
-    disp->contrast_val = current;
-    disp->contrast_max = maximum;
+    dmi_display_cache_store(disp, VCP_CONTRAST, current, maximum);
 
-    DEBUG_PRINT("Contrast: %d/%d\n", disp->contrast_val, disp->contrast_max);
+    DEBUG_PRINT("Contrast: %d/%d\n", current, maximum);
     return 0;
 }
 
-int dmi_display_set_contrast(dmi_display *disp, guint16 new_val) {
-    if (!disp || !disp->dh) return -1;
-    if (new_val > disp->contrast_max) return -1;
+int dmi_display_set_contrast(dmi_display *disp, guint16 new_val, const dmi_call *call) {
+    if (!disp || !disp->backend) return -1;
 
-    guint8 high = new_val >> 8;
-    guint8 low = new_val & 0xFF;
+    guint16 cur, max;
+    dmi_display_cached_vcp(disp, VCP_CONTRAST, &cur, &max);
+    if (new_val > max) return -1;
 
-    DDCA_Status ddcrc = ddca_set_non_table_vcp_value(disp->dh, VCP_CONTRAST, high, low);
+    int ddcrc = dmi_vcp_set(disp, VCP_CONTRAST, new_val, call, DMI_TIMEOUT_SET_MS);
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to set contrast: %d\n", ddcrc);
         return ddcrc;
     }
 
-    disp->contrast_val = new_val;
     return 0;
 }
 
-int dmi_display_get_ctemp(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
-
-    DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status ddcrc = ddca_get_non_table_vcp_value(disp->dh, VCP_CTEMP, &valrec);
+int dmi_display_get_ctemp(dmi_display *disp, const dmi_call *call) {
+    guint16 current, maximum;
+    int ddcrc = dmi_vcp_get(disp, VCP_CTEMP, &current, &maximum, TRUE, call);
 
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to get Color Temp: %d\n", ddcrc);
         return ddcrc;
     }
 
-    guint16 current = (valrec.sh << 8) | valrec.sl;
-    guint16 maximum = (valrec.mh << 8) | valrec.ml;
-
-    if (maximum == 0 || maximum > 1000) {
+    if (maximum == 0 || maximum > MAX_PLAUSIBLE) {
         DEBUG_PRINT("Invalid contrast max value: %d\n", maximum);
         return -1;
     }
 
-    disp->ctemp_val = current;
-    disp->ctemp_max = maximum;
+    dmi_display_cache_store(disp, VCP_CTEMP, current, maximum);
 
-    DEBUG_PRINT("Color Temp: %d/%d\n", disp->ctemp_val, disp->ctemp_max);
+    DEBUG_PRINT("Color Temp: %d/%d\n", current, maximum);
     return 0;
 }
 
-int dmi_display_set_ctemp(dmi_display *disp, guint16 new_val) {
-    if (!disp || !disp->dh) return -1;
-    if (new_val > disp->ctemp_max) return -1;
+int dmi_display_set_ctemp(dmi_display *disp, guint16 new_val, const dmi_call *call) {
+    if (!disp || !disp->backend) return -1;
 
-    guint8 high = new_val >> 8;
-    guint8 low = new_val & 0xFF;
+    guint16 cur, max;
+    dmi_display_cached_vcp(disp, VCP_CTEMP, &cur, &max);
+    if (new_val > max) return -1;
 
-    DDCA_Status ddcrc = ddca_set_non_table_vcp_value(disp->dh, VCP_CTEMP, high, low);
+    int ddcrc = dmi_vcp_set(disp, VCP_CTEMP, new_val, call, DMI_TIMEOUT_SET_MS);
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to set color temp: %d\n", ddcrc);
         return ddcrc;
     }
 
-    disp->ctemp_val = new_val;
     return 0;
 }
 
-int dmi_display_get_volume(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
-
-    DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status ddcrc = ddca_get_non_table_vcp_value(disp->dh, VCP_VOL, &valrec);
+int dmi_display_get_volume(dmi_display *disp, const dmi_call *call) {
+    guint16 current, maximum;
+    int ddcrc = dmi_vcp_get(disp, VCP_VOL, &current, &maximum, TRUE, call);
 
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to get volume: %d\n", ddcrc);
         return ddcrc;
     }
 
-    guint16 current = (valrec.sh << 8) | valrec.sl;
-    guint16 maximum = (valrec.mh << 8) | valrec.ml;
-
-    if (maximum == 0 || maximum > 1000) {
+    if (maximum == 0 || maximum > MAX_PLAUSIBLE) {
         DEBUG_PRINT("Invalid volume max value: %d\n", maximum);
         return -1;
     }
 
-    disp->volume_val = current;
-    disp->volume_max = maximum;
+    dmi_display_cache_store(disp, VCP_VOL, current, maximum);
 
-    DEBUG_PRINT("volume: %d/%d\n", disp->volume_val, disp->volume_max);
+    DEBUG_PRINT("volume: %d/%d\n", current, maximum);
     return 0;
 }
 
-int dmi_display_set_volume(dmi_display *disp, guint16 new_val) {
-    if (!disp || !disp->dh) return -1;
-    if (new_val > disp->volume_max) return -1;
+int dmi_display_set_volume(dmi_display *disp, guint16 new_val, const dmi_call *call) {
+    if (!disp || !disp->backend) return -1;
 
-    guint8 high = new_val >> 8;
-    guint8 low = new_val & 0xFF;
+    guint16 cur, max;
+    dmi_display_cached_vcp(disp, VCP_VOL, &cur, &max);
+    if (new_val > max) return -1;
 
-    DDCA_Status ddcrc = ddca_set_non_table_vcp_value(disp->dh, VCP_VOL, high, low);
+    int ddcrc = dmi_vcp_set(disp, VCP_VOL, new_val, call, DMI_TIMEOUT_SET_MS);
     if (ddcrc != 0) {
         DEBUG_PRINT("Failed to set volume: %d\n", ddcrc);
         return ddcrc;
     }
 
-    disp->volume_val = new_val;
     return 0;
 }
 
-int dmi_display_get_input(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
+int dmi_display_set_vcp_batch(dmi_display *disp, const dmi_vcp_write *writes, guint n,
+                              const dmi_call *call) {
+    if (!disp || !disp->backend || (!writes && n > 0)) return DMI_STATUS_ERROR;
+    if (n == 0) return 0;
+    for (guint i = 0; i < n; i++) {
+        if (dmi_quirk_unsupported(disp->quirk, writes[i].code)) return DDCRC_REPORTED_UNSUPPORTED;
+        if (!breaker_allow(disp, &disp->health[writes[i].code])) return DMI_STATUS_UNAVAILABLE;
+    }
 
-    DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status rc = ddca_get_non_table_vcp_value(disp->dh, VCP_INPUT, &valrec);
+    /* The writes are copied: a caller that times out may return before the worker is done */
+    BoundedCall *bc = bounded_call_new("setvcp batch", disp, vcp_batch_work);
+    bc->code = writes[0].code;
+    bc->writes = g_memdup2(writes, n * sizeof(dmi_vcp_write));
+    bc->n_writes = n;
+
+    int rc = bounded_call_run(bc, call, DMI_TIMEOUT_SET_MS * n);
+    if (rc == 0) rc = bc->rc;
+    for (guint i = 0; i < n; i++) {
+        if (rc == 0) display_cache_store(disp, writes[i].code, writes[i].value);
+        breaker_record_vcp(disp, writes[i].code, rc);
+    }
 
-    if (rc == 0) {
+    bounded_call_unref(bc);
+    return rc;
+}
 
-        int value = valrec.sl;
-        DEBUG_PRINT("Current input: 0x%02x (via handle)\n", value);
-        return value;
+int dmi_display_get_rgb_gains(dmi_display *disp, const dmi_call *call) {
+    guint16 cur[3], max[3];
+    static const guint8 codes[3] = {VCP_RED_GAIN, VCP_GREEN_GAIN, VCP_BLUE_GAIN};
+
+    for (int i = 0; i < 3; i++) {
+        int ddcrc = dmi_vcp_get(disp, codes[i], &cur[i], &max[i], TRUE, call);
+        if (ddcrc != 0) {
+            DEBUG_PRINT("Failed to get gain 0x%02x: %d\n", codes[i], ddcrc);
+            return ddcrc;
+        }
+        if (max[i] == 0 || max[i] > MAX_PLAUSIBLE) {
+            DEBUG_PRINT("Invalid gain max value: %d\n", max[i]);
+            return -1;
+        }
     }
 
-    if (disp->i2c_busno < 0) return -1;
+    /* All three at once, so no reader sees a mix of old and new gains */
+    cache_write_begin(disp);
+    for (int i = 0; i < 3; i++) cache_put(disp, codes[i], cur[i], &max[i]);
+    cache_write_end(disp);
+    display_notify(disp, VCP_RED_GAIN);
+
+    DEBUG_PRINT("RGB gain: %d/%d/%d\n", cur[0], cur[1], cur[2]);
+    return 0;
+}
+
+int dmi_display_set_rgb_gains(dmi_display *disp, guint16 red, guint16 green, guint16 blue,
+                              const dmi_call *call) {
+    if (!disp || !disp->backend) return -1;
 
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "ddcutil getvcp %02x --bus=%d 2>/dev/null", VCP_INPUT,
-             disp->i2c_busno);
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+    if (red > v.red_gain_max || green > v.green_gain_max || blue > v.blue_gain_max) return -1;
 
-    FILE *fp = popen(cmd, "r");
-    if (!fp) return -1;
+    dmi_vcp_write writes[3];
+    guint n = 0;
 
-    char line[MAX_LINE_LEN];
-    int value = -1;
+    if (red != v.red_gain_val) writes[n++] = (dmi_vcp_write){VCP_RED_GAIN, red};
+    if (green != v.green_gain_val) writes[n++] = (dmi_vcp_write){VCP_GREEN_GAIN, green};
+    if (blue != v.blue_gain_val) writes[n++] = (dmi_vcp_write){VCP_BLUE_GAIN, blue};
 
-    while (fgets(line, sizeof(line), fp)) {
-        if (strstr(line, "current value") != NULL) {
-            char *eq = strchr(line, '=');
-            if (eq && sscanf(eq + 1, " 0x%x", &value) == 1) {
-                break;
-            }
-        }
+    int ddcrc = dmi_display_set_vcp_batch(disp, writes, n, call);
+    if (ddcrc != 0) {
+        DEBUG_PRINT("Failed to set RGB gain: %d\n", ddcrc);
+        return ddcrc;
     }
+    return 0;
+}
+
+int dmi_display_read_vcp(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max,
+                         const dmi_call *call) {
+    if (!cur || !max) return DMI_STATUS_ERROR;
 
-    pclose(fp);
-    DEBUG_PRINT("Current input: 0x%02x (via command)\n", value);
-    return value;
+    int rc = dmi_vcp_get(disp, code, cur, max, FALSE, call);
+    if (rc == 0) display_cache_store(disp, code, *cur);
+    return rc;
 }
 
-int dmi_display_set_input(dmi_display *disp, guint8 input_code) {
-    if (!disp) return -1;
+int dmi_display_get_vcp_value(dmi_display *disp, guint8 code, guint16 *value,
+                              const dmi_call *call) {
+    if (!disp || !disp->backend || !value) return -1;
+    if (dmi_quirk_unsupported(disp->quirk, code)) return DDCRC_REPORTED_UNSUPPORTED;
+    /* An open breaker also spares the ddcutil command fallback */
+    if (!breaker_allow(disp, &disp->health[code])) return DMI_STATUS_UNAVAILABLE;
 
-    if (disp->i2c_busno < 0) {
-        g_printerr("No I2C bus number available for input switching\n");
-        return -1;
+    BoundedCall *bc = bounded_call_new("getvcp", disp, getvcp_command_work);
+    bc->code = code;
+
+    int rc = bounded_call_run(bc, call, DMI_TIMEOUT_GET_MS);
+    if (rc == 0) {
+        rc = bc->rc;
+        if (rc == 0) {
+            *value = bc->cur;
+            display_cache_store(disp, code, bc->cur);
+        }
     }
+    breaker_record_vcp(disp, code, rc);
 
-    char cmd[256];
+    bounded_call_unref(bc);
+    return rc;
+}
 
-    snprintf(cmd, sizeof(cmd), "timeout 5 ddcutil --bus=%d setvcp 0x60 0x%02x >/dev/null 2>&1",
-             disp->i2c_busno, input_code);
+int dmi_display_get_input(dmi_display *disp, const dmi_call *call) {
+    guint16 value;
+    int rc = dmi_display_get_vcp_value(disp, VCP_INPUT, &value, call);
+    if (rc != 0) return rc < 0 ? rc : -1;
 
-    DEBUG_PRINT("Executing: %s\n", cmd);
+    DEBUG_PRINT("Current input: 0x%02x\n", value);
+    return dmi_quirk_input_from_monitor(disp->quirk, value);
+}
 
-    int rc = system(cmd);
-    if (rc == 124) {
-        g_printerr("WARNING: Input switch command timed out\n");
-        return -1;
-    }
+int dmi_display_set_input(dmi_display *disp, guint8 input_code, const dmi_call *call) {
+    if (!disp) return -1;
+
+    DEBUG_PRINT("Setting input 0x%02x\n", input_code);
 
-    return (rc == 0) ? 0 : -1;
+    int code = dmi_quirk_input_to_monitor(disp->quirk, input_code);
+    return dmi_vcp_set(disp, VCP_INPUT, code, call, DMI_TIMEOUT_INPUT_MS);
 }
 
-int dmi_display_set_vcp_value(dmi_display *disp, guint8 code, guint16 value) {
+int dmi_display_set_vcp_value(dmi_display *disp, guint8 code, guint16 value,
+                              const dmi_call *call) {
     if (!disp) return -1;
 
-    if (code == VCP_INPUT || code == 0xAC || code == 0xAA) {
-        if (disp->i2c_busno < 0) return -1;
+    gint64 timeout_ms =
+        (code == VCP_INPUT || code == 0xAC || code == 0xAA) ? DMI_TIMEOUT_INPUT_MS
+                                                             : DMI_TIMEOUT_SET_MS;
 
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), "timeout 3 ddcutil --bus=%d setvcp 0x%02X %d >/dev/null 2>&1",
-                 disp->i2c_busno, code, value);
+    int rc = dmi_vcp_set(disp, code, value, call, timeout_ms);
+    if (rc != 0) {
+        DEBUG_PRINT("Failed to set VCP 0x%02x: %d\n", code, rc);
+    }
+    return rc;
+}
 
-        int rc = system(cmd);
-        if (rc == 124) {
-            g_printerr("WARNING: DDC command timed out for VCP 0x%02x\n", code);
-            return -1;
-        }
-        return (rc == 0) ? 0 : -1;
+static void supported_inputs_work(BoundedCall *bc) {
+    GArray *supported = g_array_new(FALSE, FALSE, sizeof(guint));
+    gint64 start = g_get_monotonic_time();
+
+    bc->rc = bc->disp->backend->get_inputs(bc->disp, supported);
+    dmi_journal_record(bc->disp, DMI_JOURNAL_CAPS, 0, supported->len, 0, bc->rc, start);
+    if (bc->rc == 0) {
+        bc->result = supported;
+    } else {
+        g_array_free(supported, TRUE);
     }
+}
 
-    if (disp->dh) {
-        guint8 high = value >> 8;
-        guint8 low = value & 0xFF;
+static void garray_free_all(gpointer data) {
+    g_array_free(data, TRUE);
+}
 
-        DDCA_Status rc = ddca_set_non_table_vcp_value(disp->dh, code, high, low);
+int dmi_display_get_supported_inputs(dmi_display *disp, GArray **inputs, const dmi_call *call) {
+    if (!disp || !disp->backend || !inputs) return -1;
 
-        if (rc == 0) {
-            return 0;
-        }
+    /* Capabilities never change while a monitor stays connected */
+    g_mutex_lock(&disp->cache_lock);
+    *inputs = disp->supported_inputs ? g_array_copy(disp->supported_inputs) : NULL;
+    g_mutex_unlock(&disp->cache_lock);
+    if (*inputs) return 0;
 
-        DEBUG_PRINT("Failed to set VCP 0x%02x via handle: %d, trying command line\n", code, rc);
-    }
+    if (disp->quirk && disp->quirk->no_capabilities) return DDCRC_REPORTED_UNSUPPORTED;
+    if (!breaker_allow(disp, &disp->caps_health)) return DMI_STATUS_UNAVAILABLE;
 
-    if (disp->i2c_busno >= 0) {
-        char cmd[256];
-        snprintf(cmd, sizeof(cmd), "timeout 2 ddcutil --bus=%d setvcp 0x%02X %d >/dev/null 2>&1",
-                 disp->i2c_busno, code, value);
+    BoundedCall *bc = bounded_call_new("capabilities", disp, supported_inputs_work);
+    bc->abandon = garray_free_all;
 
-        int cmd_rc = system(cmd);
-        if (cmd_rc == 124) {
-            g_printerr("WARNING: DDC command timed out for VCP 0x%02x\n", code);
-            return -1;
+    int rc = bounded_call_run(bc, call, DMI_TIMEOUT_CAPS_MS);
+    if (rc == 0) {
+        rc = bc->rc;
+        if (rc == 0) {
+            *inputs = g_steal_pointer(&bc->result);
+            /* Two callers may have asked at once; the first answer is kept */
+            g_mutex_lock(&disp->cache_lock);
+            if (!disp->supported_inputs) disp->supported_inputs = g_array_copy(*inputs);
+            g_mutex_unlock(&disp->cache_lock);
         }
-        return (cmd_rc == 0) ? 0 : -1;
     }
+    breaker_record(disp, &disp->caps_health, "capabilities", rc);
 
-    return -1;
+    bounded_call_unref(bc);
+    return rc;
 }
 
-GArray *dmi_display_get_supported_inputs(dmi_display *disp) {
-    if (!disp || disp->i2c_busno < 0) return NULL;
-
-    GArray *supported = g_array_new(FALSE, FALSE, sizeof(int));
+static char *bus_index_key(const char *mfg_id, const char *model_name, const char *sn) {
+    return sn ? g_strdup_printf("%s:%s:%s", mfg_id, model_name, sn)
+              : g_strdup_printf("%s:%s", mfg_id, model_name);
+}
 
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "ddcutil capabilities --bus=%d 2>/dev/null", disp->i2c_busno);
+static void bus_index_add(GHashTable *bus_index, const char *mfg_id, const char *model_name,
+                          const char *sn, int bus) {
+    /* Keyed both with and without the serial number, first display wins on a clash */
+    char *key = bus_index_key(mfg_id, model_name, sn);
+    if (!g_hash_table_contains(bus_index, key)) {
+        g_hash_table_insert(bus_index, key, GINT_TO_POINTER(bus));
+    } else {
+        g_free(key);
+    }
 
-    FILE *fp = popen(cmd, "r");
-    if (!fp) {
-        g_array_free(supported, TRUE);
-        return NULL;
+    key = bus_index_key(mfg_id, model_name, NULL);
+    if (!g_hash_table_contains(bus_index, key)) {
+        g_hash_table_insert(bus_index, key, GINT_TO_POINTER(bus));
+    } else {
+        g_free(key);
     }
+}
 
-    char line[MAX_LINE_LEN];
-    gboolean in_feature_60 = FALSE;
+static GHashTable *get_all_display_bus_numbers(gint64 deadline, GCancellable *cancellable) {
+    GHashTable *bus_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 
-    while (fgets(line, sizeof(line), fp)) {
-        if (strstr(line, "Feature: 60")) {
-            in_feature_60 = TRUE;
-            continue;
-        }
+    const char *argv[] = {"ddcutil", "detect", NULL};
+    GBytes *out;
+    int rc;
+    FILE *fp = command_open(argv, deadline, cancellable, &out, &rc);
+    if (!fp) return bus_index;
 
-        if (in_feature_60 && strstr(line, "Feature:")) {
-            break;
-        }
+    char line[DMI_PARSE_LINE_MAX];
+    dmi_parse_detect state, found;
+    gboolean more = TRUE;
 
-        if (in_feature_60) {
-            int code;
-            if (sscanf(line, " %x:", &code) == 1) {
-                for (size_t i = 0; i < known_inputs_count; i++) {
-                    if (known_inputs[i].code == code) {
-                        g_array_append_val(supported, i);
-                        DEBUG_PRINT("Display supports input: 0x%02x (%s)\n", code,
-                                    known_inputs[i].name);
-                        break;
-                    }
-                }
-            }
+    dmi_parse_detect_init(&state);
+    while (more) {
+        more = dmi_parse_read_line(fp, line, sizeof(line));
+        if (dmi_parse_detect_line(&state, more ? line : NULL, &found)) {
+            bus_index_add(bus_index, found.mfg, found.model, found.sn, found.bus);
         }
     }
 
-    pclose(fp);
-    return supported;
+    command_close(fp, out);
+    return bus_index;
 }
 
-static int get_all_display_bus_numbers(BusInfo **bus_info_array) {
-    FILE *fp = popen("ddcutil detect 2>/dev/null", "r");
-    if (!fp) return 0;
+static int find_bus_for_display(GHashTable *bus_index, const DDCA_Display_Info *info) {
+    if (!bus_index || !info) return -1;
 
-    BusInfo *info_array = malloc(sizeof(BusInfo) * MAX_DISPLAYS);
-    if (!info_array) {
-        pclose(fp);
-        return 0;
+    gpointer bus;
+    char *key = bus_index_key(info->mfg_id, info->model_name, info->sn);
+    gboolean found = g_hash_table_lookup_extended(bus_index, key, NULL, &bus);
+    g_free(key);
+
+    if (!found) {
+        key = bus_index_key(info->mfg_id, info->model_name, NULL);
+        found = g_hash_table_lookup_extended(bus_index, key, NULL, &bus);
+        g_free(key);
     }
 
-    int count = 0;
-    char line[MAX_LINE_LEN];
-    int current_bus = -1;
-    char current_model[64] = "";
-    char current_mfg[32] = "";
+    return found ? GPOINTER_TO_INT(bus) : -1;
+}
 
-    while (fgets(line, sizeof(line), fp) && count < MAX_DISPLAYS) {
-        if (strstr(line, "I2C bus:")) {
-            char *i2c_pos = strstr(line, "/dev/i2c-");
-            if (i2c_pos) {
-                sscanf(i2c_pos, "/dev/i2c-%d", &current_bus);
-            }
-        } else if (strstr(line, "Model:")) {
-            char *model_start = strstr(line, "Model:");
-            if (model_start) {
-                model_start += 6;
-                while (*model_start == ' ') model_start++;
+static guint64 fnv1a64(const guint8 *data, gsize len, guint64 hash) {
+    for (gsize i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
 
-                strncpy(current_model, model_start, sizeof(current_model) - 1);
-                current_model[sizeof(current_model) - 1] = '\0';
+static void display_compute_id(dmi_display *disp) {
+    guint64 hash = 0xcbf29ce484222325ULL;
 
-                char *newline = strchr(current_model, '\n');
-                if (newline) *newline = '\0';
-            }
-        } else if (strstr(line, "Mfg id:")) {
-            sscanf(line, " Mfg id: %31s", current_mfg);
-
-            if (current_bus != -1 && current_model[0] && current_mfg[0]) {
-                strcpy(info_array[count].model_name, current_model);
-                strcpy(info_array[count].mfg_id, current_mfg);
-                info_array[count].bus_number = current_bus;
-                count++;
-
-                current_bus = -1;
-                current_model[0] = '\0';
-                current_mfg[0] = '\0';
-            }
+    gboolean have_edid = FALSE;
+    for (gsize i = 0; i < sizeof(disp->info.edid_bytes); i++) {
+        if (disp->info.edid_bytes[i] != 0) {
+            have_edid = TRUE;
+            break;
         }
     }
 
-    pclose(fp);
-    *bus_info_array = info_array;
-    return count;
+    if (have_edid) {
+        hash = fnv1a64(disp->info.edid_bytes, sizeof(disp->info.edid_bytes), hash);
+        snprintf(disp->id, sizeof(disp->id), "edid-%016" G_GINT64_MODIFIER "x", hash);
+    } else {
+        /* No EDID: serial number plus connector is the best we have */
+        char fallback[128];
+        snprintf(fallback, sizeof(fallback), "%s:%s:%s@%d", disp->info.mfg_id,
+                 disp->info.model_name, disp->info.sn, disp->i2c_busno);
+        hash = fnv1a64((const guint8 *)fallback, strlen(fallback), hash);
+        snprintf(disp->id, sizeof(disp->id), "sn-%016" G_GINT64_MODIFIER "x", hash);
+    }
 }
 
-static int find_bus_for_display(BusInfo *bus_info_array, int count, const char *model_name,
-                                const char *mfg_id) {
-    if (!bus_info_array || !model_name || !mfg_id) return -1;
+void dmi_display_list_finish(dmi_display_list *dlist) {
+    if (!dlist->list) dlist->list = g_array_new(FALSE, FALSE, sizeof(dmi_display *));
 
-    for (int i = 0; i < count; i++) {
-        if (strcmp(bus_info_array[i].model_name, model_name) == 0 &&
-            strcmp(bus_info_array[i].mfg_id, mfg_id) == 0) {
-            return bus_info_array[i].bus_number;
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+
+        if (!disp->quirk) {
+            disp->quirk = dmi_quirks_lookup(disp->info.mfg_id, disp->info.product_code);
         }
+        display_compute_id(disp);
     }
-    return -1;
-}
 
-static void free_bus_info_array(BusInfo *array) {
-    free(array);
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+        guint count = GPOINTER_TO_UINT(g_hash_table_lookup(seen, disp->id));
+        g_hash_table_insert(seen, disp->id, GUINT_TO_POINTER(count + 1));
+    }
+
+    /* Identical panels with blank serials share an EDID; tell them apart by connector */
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+        if (GPOINTER_TO_UINT(g_hash_table_lookup(seen, disp->id)) > 1) {
+            gsize len = strlen(disp->id);
+            snprintf(disp->id + len, sizeof(disp->id) - len, "@%d",
+                     disp->i2c_busno >= 0 ? disp->i2c_busno : (int)i);
+        }
+    }
+    g_hash_table_destroy(seen);
+
+    dlist->index = g_hash_table_new(g_str_hash, g_str_equal);
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+        g_hash_table_insert(dlist->index, disp->id, disp);
+        g_print("  %s  %s (bus %d)\n", disp->id, disp->info.model_name, disp->i2c_busno);
+    }
 }
 
-dmi_display_list dmi_display_list_init(gboolean wait) {
-    dmi_display_list dlist = {.ct = 0, .list = NULL};
+static void list_init_work(BoundedCall *bc) {
+    dmi_display_list *dlist = g_new0(dmi_display_list, 1);
+    bc->result = dlist;
 
     DDCA_Display_Info_List *dinfos = NULL;
     DDCA_Status rc = ddca_get_display_info_list2(FALSE, &dinfos);
     if (rc != 0 || !dinfos) {
         g_printerr("Failed to get display list: %d\n", rc);
-        return dlist;
+        if (rc == 0) rc = DMI_STATUS_ERROR;
     }
 
-    BusInfo *bus_info_array = NULL;
-    int bus_count = get_all_display_bus_numbers(&bus_info_array);
-
-    DEBUG_PRINT("Found %d displays with bus info\n", bus_count);
-
-    dlist.list = g_array_new(FALSE, FALSE, sizeof(dmi_display *));
+    /* Only shell out to `ddcutil detect` if some display has no I2C path */
+    GHashTable *bus_index = NULL;
 
-    for (guint i = 0; i < dinfos->ct; i++) {
-        dmi_display *disp = g_malloc0(sizeof(dmi_display));
+    for (guint i = 0; dinfos && i < dinfos->ct; i++) {
+        dmi_display *disp = dmi_display_new(&ddc_backend, NULL);
         disp->info = dinfos->info[i];
+        disp->quirk = dmi_quirks_lookup(disp->info.mfg_id, disp->info.product_code);
 
-        if (ddca_open_display2(disp->info.dref, wait, &disp->dh) != 0) {
+        if (ddca_open_display2(disp->info.dref, bc->wait, &disp->dh) != 0) {
             g_printerr("Failed to open display %s\n", disp->info.model_name);
-            g_free(disp);
+            dmi_display_free(disp);
             continue;
         }
 
-        if (dmi_display_get_brightness(disp) != 0) {
-            g_printerr("Failed to get brightness for display %s\n", disp->info.model_name);
-            ddca_close_display(disp->dh);
-            g_free(disp);
-            continue;
-        }
-
-        if (dmi_display_get_contrast(disp) != 0) {
-            disp->contrast_val = 0;
-            disp->contrast_max = 0;
-        }
+        /* No feature reads here: the UI probes each display on its own bus worker, so one
+         * slow monitor does not hold back the window or the others */
 
         if (disp->info.path.io_mode == DDCA_IO_I2C) {
             disp->i2c_busno = disp->info.path.path.i2c_busno;
             DEBUG_PRINT("Display %s: I2C bus %d (from path)\n", disp->info.model_name,
                         disp->i2c_busno);
         } else {
+            if (!bus_index) {
+                bus_index = get_all_display_bus_numbers(bc->deadline, bc->cancellable);
+                DEBUG_PRINT("Found %u displays with bus info\n", g_hash_table_size(bus_index));
+            }
 
-            int actual_bus = find_bus_for_display(bus_info_array, bus_count, disp->info.model_name,
-                                                  disp->info.mfg_id);
+            int actual_bus = find_bus_for_display(bus_index, &disp->info);
 
             if (actual_bus != -1) {
                 disp->i2c_busno = actual_bus;
@@ -498,36 +1350,165 @@ dmi_display_list dmi_display_list_init(gboolean wait) {
             }
         }
 
-        g_array_append_val(dlist.list, disp);
-        dlist.ct++;
+        dmi_display_list_append(dlist, disp);
     }
 
-    g_print("Successfully initialized %d displays\n", dlist.ct);
+    /* The built-in panel works even when DDC detection failed */
+    dmi_backlight_list_append(dlist);
 
-    free_bus_info_array(bus_info_array);
-    ddca_free_display_info_list(dinfos);
+    if (bus_index) g_hash_table_destroy(bus_index);
+    if (dinfos) ddca_free_display_info_list(dinfos);
 
-    return dlist;
+    if (!dinfos && dlist->ct == 0) {
+        bc->rc = rc;
+        return;
+    }
+
+    dmi_display_list_finish(dlist);
+
+    g_print("Successfully initialized %d displays\n", dlist->ct);
+
+    bc->rc = 0;
+}
+
+static void display_list_abandon(gpointer data) {
+    dmi_display_list_free(data);
+    g_free(data);
+}
+
+int dmi_display_list_init(dmi_display_list *dlist, gboolean wait, const dmi_call *call) {
+    if (!dlist) return -1;
+
+    dlist->ct = 0;
+    dlist->list = NULL;
+    dlist->index = NULL;
+
+    BoundedCall *bc = bounded_call_new("display detection", NULL, list_init_work);
+    bc->wait = wait;
+    bc->abandon = display_list_abandon;
+
+    int rc = bounded_call_run(bc, call, DMI_TIMEOUT_DETECT_MS);
+    if (rc == 0) rc = bc->rc;
+
+    dmi_display_list *found = bc->result;
+    if (rc == 0 && found) {
+        *dlist = *found;
+        g_free(found);
+        bc->result = NULL;
+    }
+
+    bounded_call_unref(bc);
+    return rc;
+}
+
+#if DDCUTIL_VMAJOR > 2 || (DDCUTIL_VMAJOR == 2 && DDCUTIL_VMINOR >= 1)
+static dmi_display_list *watched_list = NULL;
+
+/* Runs on a ddcutil thread. Reads queued for a monitor that was unplugged would only time
+ * out one after another; a monitor that was just plugged in deserves a fresh chance at every
+ * feature that failed while it was away. */
+static void display_status_changed(DDCA_Display_Status_Event event) {
+    if (event.event_type != DDCA_EVENT_DISPLAY_CONNECTED &&
+        event.event_type != DDCA_EVENT_DISPLAY_DISCONNECTED &&
+        event.event_type != DDCA_EVENT_DDC_ENABLED) {
+        return;
+    }
+
+    dmi_display_list *dlist = g_atomic_pointer_get(&watched_list);
+    for (guint i = 0; dlist && i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+        gboolean same_bus = event.io_path.io_mode == DDCA_IO_I2C &&
+                            event.io_path.path.i2c_busno == disp->i2c_busno;
+
+        if (!same_bus && !(event.dref && event.dref == disp->info.dref)) continue;
+
+        if (event.event_type == DDCA_EVENT_DISPLAY_DISCONNECTED) {
+            DEBUG_PRINT("%s disconnected, dropping its queued jobs\n", disp->info.model_name);
+            dmi_sched_drop_display(disp);
+        } else {
+            DEBUG_PRINT("Display event %d on %s, resetting health\n", event.event_type,
+                        disp->info.model_name);
+            dmi_display_reset_health(disp);
+            if (event.event_type == DDCA_EVENT_DISPLAY_CONNECTED) {
+                g_atomic_int_set(&disp->handle_stale, TRUE);
+            }
+        }
+    }
+}
+#endif
+
+void dmi_display_list_watch(dmi_display_list *dlist) {
+#if DDCUTIL_VMAJOR > 2 || (DDCUTIL_VMAJOR == 2 && DDCUTIL_VMINOR >= 1)
+    if (!dlist || watched_list) return;
+
+    g_atomic_pointer_set(&watched_list, dlist);
+    DDCA_Status rc = ddca_register_display_status_callback(display_status_changed);
+    /* Not DDCA_EVENT_CLASS_ALL: the DPMS class polls every monitor over DDC from a thread of
+     * its own, outside the bus workers, and keeps an idle instance waking up */
+    if (rc == 0) rc = ddca_start_watch_displays(DDCA_EVENT_CLASS_DISPLAY_CONNECTION);
+    if (rc != 0) {
+        g_printerr("Display hotplug events unavailable: %d\n", rc);
+        g_atomic_pointer_set(&watched_list, NULL);
+    }
+#endif
 }
 
 void dmi_display_list_free(dmi_display_list *dlist) {
     if (!dlist || !dlist->list) return;
 
+#if DDCUTIL_VMAJOR > 2 || (DDCUTIL_VMAJOR == 2 && DDCUTIL_VMINOR >= 1)
+    if (watched_list == dlist) {
+        ddca_stop_watch_displays(TRUE);
+        g_atomic_pointer_set(&watched_list, NULL);
+    }
+#endif
+
     for (guint i = 0; i < dlist->ct; i++) {
-        dmi_display *disp = g_array_index(dlist->list, dmi_display *, i);
-        if (disp) {
-            if (disp->dh) {
-                ddca_close_display(disp->dh);
-            }
-            g_free(disp);
-        }
+        dmi_display_free(g_array_index(dlist->list, dmi_display *, i));
     }
     g_array_free(dlist->list, TRUE);
     dlist->list = NULL;
     dlist->ct = 0;
+
+    if (dlist->index) {
+        g_hash_table_destroy(dlist->index);
+        dlist->index = NULL;
+    }
+}
+
+dmi_display *dmi_display_new(const dmi_backend *backend, gpointer backend_data) {
+    dmi_display *disp = g_new0(dmi_display, 1);
+    disp->backend = backend;
+    disp->ref = 1;
+    disp->backend_data = backend_data;
+    disp->i2c_busno = -1;
+    disp->cache.input_val = -1;
+    g_mutex_init(&disp->io_lock);
+    g_mutex_init(&disp->cache_lock);
+    g_mutex_init(&disp->health_lock);
+    return disp;
+}
+
+void dmi_display_free(dmi_display *disp) {
+    if (disp) display_unref(disp);
+}
+
+void dmi_display_list_append(dmi_display_list *dlist, dmi_display *disp) {
+    /* A finished list may already be shared with other threads */
+    g_return_if_fail(dlist->index == NULL);
+
+    if (!dlist->list) dlist->list = g_array_new(FALSE, FALSE, sizeof(dmi_display *));
+
+    g_array_append_val(dlist->list, disp);
+    dlist->ct++;
 }
 
 dmi_display *dmi_display_list_get(dmi_display_list *dlist, guint index) {
     if (!dlist || !dlist->list || index >= dlist->ct) return NULL;
     return g_array_index(dlist->list, dmi_display *, index);
+}
+
+dmi_display *dmi_display_list_lookup(dmi_display_list *dlist, const char *id) {
+    if (!dlist || !dlist->index || !id) return NULL;
+    return g_hash_table_lookup(dlist->index, id);
 }
\ No newline at end of file
@@ -2,19 +2,64 @@
 #define DMI_API_H
 
 #include <ddcutil_c_api.h>
+#include <gio/gio.h>
 #include <glib.h>
 
 typedef struct _dmi_display dmi_display;
 typedef struct _dmi_display_list dmi_display_list;
+typedef struct _dmi_backend dmi_backend;
+typedef struct _dmi_quirk dmi_quirk;
 
 typedef struct {
     int code;
     const char *name;
 } InputSource;
 
-struct _dmi_display {
-    DDCA_Display_Info info;
-    DDCA_Display_Handle dh;
+/* Statuses returned by dmi-api besides 0 and raw DDCA_Status codes */
+#define DMI_STATUS_ERROR (-1)
+#define DMI_STATUS_TIMEOUT (-9001)
+#define DMI_STATUS_CANCELLED (-9002)
+/* The feature failed repeatedly and is not tried again until its backoff expires */
+#define DMI_STATUS_UNAVAILABLE (-9003)
+/* The display's handle went stale and it could not be opened again */
+#define DMI_STATUS_DISCONNECTED (-9004)
+/* Another call on the display timed out and still holds it; nothing was sent */
+#define DMI_STATUS_BUSY (-9005)
+
+/*
+ * Per-call limits. deadline is a g_get_monotonic_time() value, 0 uses the default timeout
+ * of the operation. Passing NULL for the whole struct means defaults and no cancellation.
+ * On timeout the call returns DMI_STATUS_TIMEOUT and the stuck I/O is left to finish on a
+ * pool worker, which is reaped once it returns. Until then further calls on that display
+ * return DMI_STATUS_BUSY at once instead of queueing behind it.
+ */
+typedef struct {
+    gint64 deadline;
+    GCancellable *cancellable;
+} dmi_call;
+
+typedef struct {
+    guint8 code;
+    guint16 value;
+} dmi_vcp_write;
+
+/*
+ * Per-feature circuit breaker. After a few consecutive failures a feature fails fast with
+ * DMI_STATUS_UNAVAILABLE; once the backoff expires a single call probes the monitor again,
+ * and every failed probe doubles the backoff.
+ */
+typedef struct {
+    guint8 failures;
+    guint8 trips;
+    gint64 open_until;
+} dmi_feature_health;
+
+/* "edid-" plus 16 hex digits, with "@<bus>" appended when identical monitors share an EDID */
+#define DMI_DISPLAY_ID_LEN 40
+
+/* Cached results of the last successful read or write. A maximum of 0 means the feature is
+ * missing; input_val is the current input in known_inputs terms, -1 when unknown. */
+typedef struct {
     guint16 brightness_val;
     guint16 brightness_max;
     guint16 contrast_val;
@@ -23,37 +68,125 @@ struct _dmi_display {
     guint16 ctemp_max;
     guint16 volume_val;
     guint16 volume_max;
+    guint16 red_gain_val;
+    guint16 red_gain_max;
+    guint16 green_gain_val;
+    guint16 green_gain_max;
+    guint16 blue_gain_val;
+    guint16 blue_gain_max;
+    int input_val;
+} dmi_display_values;
+
+/*
+ * Every dmi_display_* call may be made from any thread. io_lock serializes the bus of one
+ * display only, so calls on different displays run in parallel. The cache is written by
+ * dmi-api alone, under cache_lock with cache_seq odd while it changes, and read without
+ * locking through dmi_display_snapshot().
+ */
+struct _dmi_display {
+    char id[DMI_DISPLAY_ID_LEN];
+    /* One for the owning list plus one per pending bounded call */
+    gint ref;
+    DDCA_Display_Info info;
+    DDCA_Display_Handle dh;
+    const dmi_backend *backend;
+    gpointer backend_data;
+    const dmi_quirk *quirk;
+    GMutex io_lock;
+    /* End of the last command, kept only for models with a quirk spacing */
+    gint64 last_io_us;
+    /* Limits of the call holding io_lock, for backends that spawn helper processes */
+    gint64 io_deadline;
+    GCancellable *io_cancellable;
+    /* Set when the monitor came back on the bus; the next call reopens the handle first */
+    gint handle_stale;
+    /* Calls whose caller timed out while they were still running or waiting for io_lock;
+     * new calls fail fast with DMI_STATUS_BUSY until these return */
+    gint io_abandoned;
+    GMutex cache_lock;
+    guint cache_seq;
+    dmi_display_values cache;
+    /* Guarded by cache_lock */
+    GArray *supported_inputs;
+    /* Main thread only: set by the UI once a full probe has filled the cache */
+    gboolean cache_primed;
     int i2c_busno;
+    GMutex health_lock;
+    dmi_feature_health health[256];
+    dmi_feature_health caps_health;
 };
 
+/*
+ * The list belongs to whoever initialized it. It is complete once init (or its async
+ * finish, or a backend's finish) returns and never changes afterwards, so any thread may
+ * get and look up displays without locking. Free it only after every thread using its
+ * displays has stopped.
+ */
 struct _dmi_display_list {
     guint ct;
     GArray *list;
+    GHashTable *index;
 };
 
-dmi_display_list dmi_display_list_init(gboolean wait);
+int dmi_display_list_init(dmi_display_list *dlist, gboolean wait, const dmi_call *call);
 void dmi_display_list_free(dmi_display_list *dlist);
 dmi_display *dmi_display_list_get(dmi_display_list *dlist, guint index);
+dmi_display *dmi_display_list_lookup(dmi_display_list *dlist, const char *id);
+
+int dmi_display_get_brightness(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_brightness(dmi_display *disp, guint16 new_val, const dmi_call *call);
+
+int dmi_display_get_contrast(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_contrast(dmi_display *disp, guint16 new_val, const dmi_call *call);
+
+int dmi_display_get_ctemp(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_ctemp(dmi_display *disp, guint16 new_val, const dmi_call *call);
+
+int dmi_display_get_volume(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_volume(dmi_display *disp, guint16 new_val, const dmi_call *call);
+
+/* Red, green and blue video gain (VCP 0x16/0x18/0x1A). The setter only writes the channels
+ * that differ from the cache and sends them as one batch. */
+int dmi_display_get_rgb_gains(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_rgb_gains(dmi_display *disp, guint16 red, guint16 green, guint16 blue,
+                              const dmi_call *call);
 
-int dmi_display_get_brightness(dmi_display *disp);
-int dmi_display_set_brightness(dmi_display *disp, guint16 new_val);
+int dmi_display_get_input(dmi_display *disp, const dmi_call *call);
+int dmi_display_set_input(dmi_display *disp, guint8 input_code, const dmi_call *call);
+int dmi_display_get_supported_inputs(dmi_display *disp, GArray **inputs, const dmi_call *call);
 
-int dmi_display_get_contrast(dmi_display *disp);
-int dmi_display_set_contrast(dmi_display *disp, guint16 new_val);
+int dmi_display_get_vcp_value(dmi_display *disp, guint8 code, guint16 *value,
+                              const dmi_call *call);
+int dmi_display_set_vcp_value(dmi_display *disp, guint8 code, guint16 value,
+                              const dmi_call *call);
+/* Full 16-bit current and maximum value of any non-table feature */
+int dmi_display_read_vcp(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max,
+                         const dmi_call *call);
 
-int dmi_display_get_ctemp(dmi_display *disp);
-int dmi_display_set_ctemp(dmi_display *disp, guint16 new_val);
+/* Writes several features back to back under one hold of the display, spaced by at least
+ * DMI_BATCH_SPACING_MS; the values are read back once the last one is written */
+#define DMI_BATCH_SPACING_MS 50
+int dmi_display_set_vcp_batch(dmi_display *disp, const dmi_vcp_write *writes, guint n,
+                              const dmi_call *call);
 
-int dmi_display_get_volume(dmi_display *disp);
-int dmi_display_set_volume(dmi_display *disp, guint16 new_val);
+/* Consistent copy of the cached values, taken without locking */
+void dmi_display_snapshot(const dmi_display *disp, dmi_display_values *out);
+/* Cached value and maximum of one feature, FALSE for features the cache does not keep */
+gboolean dmi_display_cached_vcp(const dmi_display *disp, guint8 code, guint16 *cur,
+                                guint16 *max);
+/* Drops a continuous feature from the cache as if the monitor lacked it */
+void dmi_display_forget(dmi_display *disp, guint8 code);
 
-int dmi_display_get_input(dmi_display *disp);
-int dmi_display_set_input(dmi_display *disp, guint8 input_code);
-GArray *dmi_display_get_supported_inputs(dmi_display *disp);
+/* Closes every breaker of disp, so the next call of each feature goes to the monitor */
+void dmi_display_reset_health(dmi_display *disp);
+/* Resets health on hotplug events where ddcutil reports them (2.1 and later) */
+void dmi_display_list_watch(dmi_display_list *dlist);
 
-int dmi_display_set_vcp_value(dmi_display *disp, guint8 code, guint16 value);
+/* Called after a cached value or maximum changes, from whichever thread did the I/O */
+typedef void (*dmi_value_observer)(dmi_display *disp, guint8 code, gpointer user_data);
+void dmi_set_value_observer(dmi_value_observer observer, gpointer user_data);
 
 extern const InputSource known_inputs[];
 extern const size_t known_inputs_count;
 
-#endif
\ No newline at end of file
+#endif
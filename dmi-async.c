@@ -0,0 +1,241 @@
+#include "dmi-async.h"
+#include "dmi-sched.h"
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-ASYNC] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef enum {
+    ASYNC_READ_VCP,
+    ASYNC_SET_VCP,
+    ASYNC_GET_INPUT,
+    ASYNC_SET_INPUT,
+    ASYNC_GET_INPUTS,
+} AsyncKind;
+
+typedef struct {
+    AsyncKind kind;
+    guint8 code;
+    guint16 value;
+    guint16 cur;
+    guint16 max;
+    gboolean ran;
+} AsyncOp;
+
+typedef struct {
+    dmi_display_list *dlist;
+    gboolean wait;
+} ListInit;
+
+G_DEFINE_QUARK(dmi-error-quark, dmi_error)
+
+static void async_return_status(GTask *task, int rc) {
+    if (rc == DMI_STATUS_CANCELLED && g_task_return_error_if_cancelled(task)) return;
+
+    g_task_return_new_error(task, DMI_ERROR, rc, "%s failed: %d", g_task_get_name(task), rc);
+}
+
+/* Runs on the bus worker */
+static void async_job(dmi_display *disp, gpointer data) {
+    GTask *task = data;
+    AsyncOp *op = g_task_get_task_data(task);
+    dmi_call call = {.cancellable = g_task_get_cancellable(task)};
+    GArray *inputs = NULL;
+    int rc;
+
+    op->ran = TRUE;
+
+    switch (op->kind) {
+    case ASYNC_READ_VCP:
+        rc = dmi_display_read_vcp(disp, op->code, &op->cur, &op->max, &call);
+        break;
+    case ASYNC_SET_VCP:
+        rc = dmi_display_set_vcp_value(disp, op->code, op->value, &call);
+        break;
+    case ASYNC_GET_INPUT:
+        rc = dmi_display_get_input(disp, &call);
+        if (rc >= 0) {
+            g_task_return_int(task, rc);
+            return;
+        }
+        break;
+    case ASYNC_SET_INPUT:
+        rc = dmi_display_set_input(disp, op->code, &call);
+        break;
+    case ASYNC_GET_INPUTS:
+        rc = dmi_display_get_supported_inputs(disp, &inputs, &call);
+        if (rc == 0) {
+            g_task_return_pointer(task, inputs, (GDestroyNotify)g_array_unref);
+            return;
+        }
+        break;
+    default:
+        rc = DMI_STATUS_ERROR;
+        break;
+    }
+
+    if (rc == 0) {
+        g_task_return_boolean(task, TRUE);
+    } else {
+        async_return_status(task, rc);
+    }
+}
+
+static gboolean async_superseded(gpointer data) {
+    GTask *task = data;
+
+    g_task_return_new_error(task, DMI_ERROR, DMI_STATUS_CANCELLED, "%s superseded",
+                            g_task_get_name(task));
+    return G_SOURCE_REMOVE;
+}
+
+/* Also runs for jobs that never ran: replaced by a newer write, or dropped with their
+ * display. The scheduler may hold its lock here, so the error goes out from an idle. */
+static void async_job_free(gpointer data) {
+    GTask *task = data;
+    AsyncOp *op = g_task_get_task_data(task);
+
+    if (!op->ran) {
+        DEBUG_PRINT("%s dropped before it ran\n", g_task_get_name(task));
+        GSource *source = g_idle_source_new();
+        g_task_attach_source(task, source, async_superseded);
+        g_source_unref(source);
+    }
+    g_object_unref(task);
+}
+
+static void async_submit(dmi_display *disp, AsyncOp *op, guint key, const char *name,
+                         int io_priority, GCancellable *cancellable, GAsyncReadyCallback callback,
+                         gpointer user_data, gpointer source_tag) {
+    GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, source_tag);
+    g_task_set_name(task, name);
+    g_task_set_priority(task, io_priority);
+    g_task_set_task_data(task, op, g_free);
+
+    dmi_sched_prio prio =
+        io_priority <= G_PRIORITY_DEFAULT ? DMI_SCHED_INTERACTIVE : DMI_SCHED_BACKGROUND;
+    dmi_sched_submit(disp, prio, key, async_job, task, async_job_free);
+}
+
+static AsyncOp *async_op_new(AsyncKind kind, guint8 code, guint16 value) {
+    AsyncOp *op = g_new0(AsyncOp, 1);
+    op->kind = kind;
+    op->code = code;
+    op->value = value;
+    return op;
+}
+
+static void list_init_thread(GTask *task, gpointer source, gpointer data,
+                             GCancellable *cancellable) {
+    ListInit *init = data;
+    dmi_call call = {.cancellable = cancellable};
+
+    int rc = dmi_display_list_init(init->dlist, init->wait, &call);
+    if (rc == 0) {
+        g_task_return_boolean(task, TRUE);
+    } else {
+        async_return_status(task, rc);
+    }
+}
+
+void dmi_display_list_init_async(dmi_display_list *dlist, gboolean wait,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback,
+                                 gpointer user_data) {
+    GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, dmi_display_list_init_async);
+    g_task_set_name(task, "display detection");
+
+    ListInit *init = g_new0(ListInit, 1);
+    init->dlist = dlist;
+    init->wait = wait;
+    g_task_set_task_data(task, init, g_free);
+
+    g_task_run_in_thread(task, list_init_thread);
+    g_object_unref(task);
+}
+
+gboolean dmi_display_list_init_finish(GAsyncResult *result, GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+void dmi_display_read_vcp_async(dmi_display *disp, guint8 code, int io_priority,
+                                GCancellable *cancellable, GAsyncReadyCallback callback,
+                                gpointer user_data) {
+    async_submit(disp, async_op_new(ASYNC_READ_VCP, code, 0), 0, "getvcp", io_priority,
+                 cancellable, callback, user_data, dmi_display_read_vcp_async);
+}
+
+gboolean dmi_display_read_vcp_finish(GAsyncResult *result, guint16 *cur, guint16 *max,
+                                     GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+
+    AsyncOp *op = g_task_get_task_data(G_TASK(result));
+    if (!g_task_propagate_boolean(G_TASK(result), error)) return FALSE;
+
+    if (cur) *cur = op->cur;
+    if (max) *max = op->max;
+    return TRUE;
+}
+
+void dmi_display_set_vcp_async(dmi_display *disp, guint8 code, guint16 value, int io_priority,
+                               GCancellable *cancellable, GAsyncReadyCallback callback,
+                               gpointer user_data) {
+    /* Coalesced like the UI's own writes: only the newest queued value goes to the bus */
+    async_submit(disp, async_op_new(ASYNC_SET_VCP, code, value), DMI_SCHED_KEY_VCP(code),
+                 "setvcp", io_priority, cancellable, callback, user_data,
+                 dmi_display_set_vcp_async);
+}
+
+gboolean dmi_display_set_vcp_finish(GAsyncResult *result, GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+void dmi_display_get_input_async(dmi_display *disp, int io_priority, GCancellable *cancellable,
+                                 GAsyncReadyCallback callback, gpointer user_data) {
+    async_submit(disp, async_op_new(ASYNC_GET_INPUT, 0, 0), 0, "get input", io_priority,
+                 cancellable, callback, user_data, dmi_display_get_input_async);
+}
+
+int dmi_display_get_input_finish(GAsyncResult *result, GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), -1);
+
+    GError *local = NULL;
+    gssize code = g_task_propagate_int(G_TASK(result), &local);
+    if (local) {
+        g_propagate_error(error, local);
+        return -1;
+    }
+    return (int)code;
+}
+
+void dmi_display_set_input_async(dmi_display *disp, guint8 input_code, int io_priority,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback,
+                                 gpointer user_data) {
+    async_submit(disp, async_op_new(ASYNC_SET_INPUT, input_code, 0), DMI_SCHED_KEY_VCP(0x60),
+                 "input switch", io_priority, cancellable, callback, user_data,
+                 dmi_display_set_input_async);
+}
+
+gboolean dmi_display_set_input_finish(GAsyncResult *result, GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+void dmi_display_get_supported_inputs_async(dmi_display *disp, int io_priority,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback, gpointer user_data) {
+    async_submit(disp, async_op_new(ASYNC_GET_INPUTS, 0, 0), 0, "capabilities", io_priority,
+                 cancellable, callback, user_data, dmi_display_get_supported_inputs_async);
+}
+
+GArray *dmi_display_get_supported_inputs_finish(GAsyncResult *result, GError **error) {
+    g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
@@ -0,0 +1,57 @@
+#ifndef DMI_ASYNC_H
+#define DMI_ASYNC_H
+
+#include "dmi-api.h"
+
+#include <gio/gio.h>
+
+/*
+ * GIO-style variants of the blocking dmi-api calls. Each display operation runs as a job on
+ * the display's dmi_sched bus worker (dmi_sched_init() must have been called), so operations
+ * on one bus never overlap and queue with the UI's own jobs, interactive ones first. The
+ * callback is invoked in the thread-default main context of the thread that started it.
+ *
+ * io_priority G_PRIORITY_DEFAULT or higher queues as an interactive job, anything lower as
+ * a background job. Errors are in the DMI_ERROR domain with the dmi-api status as their
+ * code, or G_IO_ERROR_CANCELLED once the cancellable fired. A queued feature write that a
+ * newer write of the same feature replaced fails with DMI_STATUS_CANCELLED.
+ */
+
+#define DMI_ERROR (dmi_error_quark())
+GQuark dmi_error_quark(void);
+
+/* Detection runs on a GIO worker thread; dlist must stay untouched until finish */
+void dmi_display_list_init_async(dmi_display_list *dlist, gboolean wait,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback,
+                                 gpointer user_data);
+gboolean dmi_display_list_init_finish(GAsyncResult *result, GError **error);
+
+/* Any non-table feature; the cache is updated as with dmi_display_read_vcp() */
+void dmi_display_read_vcp_async(dmi_display *disp, guint8 code, int io_priority,
+                                GCancellable *cancellable, GAsyncReadyCallback callback,
+                                gpointer user_data);
+gboolean dmi_display_read_vcp_finish(GAsyncResult *result, guint16 *cur, guint16 *max,
+                                     GError **error);
+
+void dmi_display_set_vcp_async(dmi_display *disp, guint8 code, guint16 value, int io_priority,
+                               GCancellable *cancellable, GAsyncReadyCallback callback,
+                               gpointer user_data);
+gboolean dmi_display_set_vcp_finish(GAsyncResult *result, GError **error);
+
+/* Current input as a known_inputs code, -1 on error */
+void dmi_display_get_input_async(dmi_display *disp, int io_priority, GCancellable *cancellable,
+                                 GAsyncReadyCallback callback, gpointer user_data);
+int dmi_display_get_input_finish(GAsyncResult *result, GError **error);
+
+void dmi_display_set_input_async(dmi_display *disp, guint8 input_code, int io_priority,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback,
+                                 gpointer user_data);
+gboolean dmi_display_set_input_finish(GAsyncResult *result, GError **error);
+
+/* Indices into known_inputs, owned by the caller; NULL on error */
+void dmi_display_get_supported_inputs_async(dmi_display *disp, int io_priority,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback, gpointer user_data);
+GArray *dmi_display_get_supported_inputs_finish(GAsyncResult *result, GError **error);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef DMI_BACKEND_H
+#define DMI_BACKEND_H
+
+#include "dmi-api.h"
+
+/*
+ * Transport behind a dmi_display. Operations run on a dmi-api pool worker with the
+ * display's io_lock held and may block; dmi-api applies deadlines and caching on top.
+ */
+struct _dmi_backend {
+    const char *name;
+    int (*get_vcp)(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max);
+    int (*set_vcp)(dmi_display *disp, guint8 code, guint16 value);
+    /* Optional; defaults to set_vcp calls spaced by DMI_BATCH_SPACING_MS */
+    int (*set_vcp_batch)(dmi_display *disp, const dmi_vcp_write *writes, guint n);
+    /* Fills supported with indices into known_inputs */
+    int (*get_inputs)(dmi_display *disp, GArray *supported);
+    void (*close)(dmi_display *disp);
+    /* Optional; replaces a handle that stopped working, keeping everything else */
+    int (*reopen)(dmi_display *disp);
+};
+
+dmi_display *dmi_display_new(const dmi_backend *backend, gpointer backend_data);
+/* Drops the owner's reference. A call abandoned on a timeout keeps its own, so the backend
+ * is closed only once that stuck I/O has returned. */
+void dmi_display_free(dmi_display *disp);
+
+/* For backends that build their own lists: append, then finish to assign ids and index */
+void dmi_display_list_append(dmi_display_list *dlist, dmi_display *disp);
+void dmi_display_list_finish(dmi_display_list *dlist);
+
+/* Stores a value and maximum as if they had just been read, e.g. to seed a new display */
+void dmi_display_cache_store(dmi_display *disp, guint8 code, guint16 value, guint16 max);
+
+void dmi_inputs_add_code(dmi_display *disp, GArray *supported, int code);
+
+/* The default batch write, for backends that wrap it */
+int dmi_vcp_write_spaced(dmi_display *disp, const dmi_vcp_write *writes, guint n);
+
+#endif
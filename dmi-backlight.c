@@ -0,0 +1,287 @@
+#include "dmi-backlight.h"
+#include "dmi-backend.h"
+
+#include <ddcutil_status_codes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BACKLIGHT_CLASS "/sys/class/backlight"
+#define DRM_CLASS "/sys/class/drm"
+#define BACKLIGHT_MODEL "Laptop panel"
+#define BACKLIGHT_INPUT 0x20 /* "Internal DisplayPort" in known_inputs */
+#define LOGIND_TIMEOUT_MS 1000
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-BACKLIGHT] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    char *name;
+    char *dir;
+    guint max;
+    /* max_brightness can exceed what a VCP value holds; values are scaled to this many */
+    guint16 steps;
+    gboolean use_logind;
+    GDBusConnection *system_bus;
+} Backlight;
+
+/* The kernel's advice for picking among several interfaces to the same panel: firmware
+ * first, then platform, then raw. -1 for anything else. */
+static int backlight_rank(const char *type) {
+    static const char *const order[] = {"firmware", "platform", "raw"};
+
+    for (guint i = 0; i < G_N_ELEMENTS(order); i++) {
+        if (g_strcmp0(type, order[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static char *read_attr(const char *dir, const char *attr) {
+    char *path = g_build_filename(dir, attr, NULL);
+    char *contents = NULL;
+
+    g_file_get_contents(path, &contents, NULL, NULL);
+    g_free(path);
+    return contents ? g_strstrip(contents) : NULL;
+}
+
+static gboolean read_uint(const char *dir, const char *attr, guint *value) {
+    char *contents = read_attr(dir, attr);
+    if (!contents) return FALSE;
+
+    char *end;
+    guint64 v = g_ascii_strtoull(contents, &end, 10);
+    gboolean ok = end != contents && *end == '\0' && v <= G_MAXUINT;
+    g_free(contents);
+
+    if (ok) *value = (guint)v;
+    return ok;
+}
+
+static int backlight_get_vcp(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max) {
+    Backlight *bl = disp->backend_data;
+
+    if (code == 0x60) {
+        *cur = BACKLIGHT_INPUT;
+        *max = 0;
+        return 0;
+    }
+    if (code != 0x10) return DDCRC_REPORTED_UNSUPPORTED;
+
+    /* What the hardware is at, which lags behind brightness while it fades */
+    guint raw;
+    if (!read_uint(bl->dir, "actual_brightness", &raw) &&
+        !read_uint(bl->dir, "brightness", &raw)) {
+        return DMI_STATUS_ERROR;
+    }
+
+    *cur = ((guint64)MIN(raw, bl->max) * bl->steps + bl->max / 2) / bl->max;
+    *max = bl->steps;
+    return 0;
+}
+
+static int backlight_write_sysfs(Backlight *bl, guint raw) {
+    char *path = g_build_filename(bl->dir, "brightness", NULL);
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    g_free(path);
+    if (fd < 0) return -errno;
+
+    char buf[16];
+    int len = snprintf(buf, sizeof(buf), "%u\n", raw);
+    int rc = write(fd, buf, len) == len ? 0 : -errno;
+    close(fd);
+    return rc;
+}
+
+static int backlight_write_logind(Backlight *bl, guint raw) {
+    GError *error = NULL;
+
+    if (!bl->system_bus) {
+        bl->system_bus = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+        if (!bl->system_bus) {
+            g_printerr("%s: no system bus for logind: %s\n", bl->name, error->message);
+            g_error_free(error);
+            return DMI_STATUS_ERROR;
+        }
+    }
+
+    GVariant *reply = g_dbus_connection_call_sync(
+        bl->system_bus, "org.freedesktop.login1", "/org/freedesktop/login1/session/auto",
+        "org.freedesktop.login1.Session", "SetBrightness",
+        g_variant_new("(ssu)", "backlight", bl->name, raw), NULL, G_DBUS_CALL_FLAGS_NONE,
+        LOGIND_TIMEOUT_MS, NULL, &error);
+    if (!reply) {
+        g_printerr("%s: logind SetBrightness failed: %s\n", bl->name, error->message);
+        g_error_free(error);
+        return DMI_STATUS_ERROR;
+    }
+
+    g_variant_unref(reply);
+    return 0;
+}
+
+static int backlight_set_vcp(dmi_display *disp, guint8 code, guint16 value) {
+    Backlight *bl = disp->backend_data;
+
+    if (code == 0x60) return value == BACKLIGHT_INPUT ? 0 : DDCRC_REPORTED_UNSUPPORTED;
+    if (code != 0x10) return DDCRC_REPORTED_UNSUPPORTED;
+
+    guint raw = ((guint64)MIN(value, bl->steps) * bl->max + bl->steps / 2) / bl->steps;
+
+    /* Without a udev rule only root may write sysfs; after the first refusal every write
+     * goes to logind */
+    if (!bl->use_logind) {
+        int rc = backlight_write_sysfs(bl, raw);
+        if (rc != -EACCES && rc != -EPERM && rc != -EROFS) return rc;
+
+        DEBUG_PRINT("%s: sysfs not writable, using logind\n", bl->name);
+        bl->use_logind = TRUE;
+    }
+    return backlight_write_logind(bl, raw);
+}
+
+static int backlight_get_inputs(dmi_display *disp, GArray *supported) {
+    dmi_inputs_add_code(disp, supported, BACKLIGHT_INPUT);
+    return 0;
+}
+
+static void backlight_close(dmi_display *disp) {
+    Backlight *bl = disp->backend_data;
+    if (!bl) return;
+
+    g_clear_object(&bl->system_bus);
+    g_free(bl->name);
+    g_free(bl->dir);
+    g_free(bl);
+    disp->backend_data = NULL;
+}
+
+static const dmi_backend backlight_backend = {
+    .name = "backlight",
+    .get_vcp = backlight_get_vcp,
+    .set_vcp = backlight_set_vcp,
+    .get_inputs = backlight_get_inputs,
+    .close = backlight_close,
+};
+
+static gboolean is_internal_connector(const char *name) {
+    return strstr(name, "-eDP-") || strstr(name, "-LVDS-") || strstr(name, "-DSI-");
+}
+
+/* Raw backlights hang off the panel's DRM connector; firmware ones do not, so the connected
+ * internal connector is looked up instead */
+static gboolean read_panel_edid(const char *dir, guint8 *edid, gsize size) {
+    char *path = g_build_filename(dir, "device", "edid", NULL);
+    char *contents = NULL;
+    gsize len = 0;
+
+    g_file_get_contents(path, &contents, &len, NULL);
+    g_free(path);
+
+    GDir *drm = contents && len >= size ? NULL : g_dir_open(DRM_CLASS, 0, NULL);
+    const char *name;
+    while (drm && (name = g_dir_read_name(drm))) {
+        if (!is_internal_connector(name)) continue;
+
+        char *connector = g_build_filename(DRM_CLASS, name, NULL);
+        char *status = read_attr(connector, "status");
+        if (g_strcmp0(status, "connected") == 0) {
+            path = g_build_filename(connector, "edid", NULL);
+            g_free(contents);
+            contents = NULL;
+            g_file_get_contents(path, &contents, &len, NULL);
+            g_free(path);
+        }
+        g_free(status);
+        g_free(connector);
+        if (contents && len >= size) break;
+    }
+    if (drm) g_dir_close(drm);
+
+    gboolean found = contents && len >= size;
+    if (found) memcpy(edid, contents, size);
+    g_free(contents);
+    return found;
+}
+
+static void backlight_fill_info(dmi_display *disp, Backlight *bl) {
+    DDCA_Display_Info *info = &disp->info;
+    guint8 *edid = info->edid_bytes;
+
+    g_strlcpy(info->model_name, BACKLIGHT_MODEL, sizeof(info->model_name));
+    g_strlcpy(info->sn, bl->name, sizeof(info->sn));
+
+    /* Same manufacturer and product as ddcutil would report, so quirks can match */
+    if (read_panel_edid(bl->dir, edid, sizeof(info->edid_bytes))) {
+        info->mfg_id[0] = '@' + ((edid[8] >> 2) & 0x1f);
+        info->mfg_id[1] = '@' + (((edid[8] & 0x03) << 3) | (edid[9] >> 5));
+        info->mfg_id[2] = '@' + (edid[9] & 0x1f);
+        info->mfg_id[3] = '\0';
+        info->product_code = edid[10] | edid[11] << 8;
+    }
+}
+
+guint dmi_backlight_list_append(dmi_display_list *dlist) {
+    GDir *dir = g_dir_open(BACKLIGHT_CLASS, 0, NULL);
+    if (!dir) return 0;
+
+    /* Indexed by rank */
+    GPtrArray *found[3] = {g_ptr_array_new(), g_ptr_array_new(), g_ptr_array_new()};
+    const char *name;
+
+    while ((name = g_dir_read_name(dir))) {
+        /* External monitors driven by the ddcci module are already on the list through DDC */
+        if (g_str_has_prefix(name, "ddcci")) continue;
+
+        char *path = g_build_filename(BACKLIGHT_CLASS, name, NULL);
+        char *type = read_attr(path, "type");
+        int rank = backlight_rank(type);
+        guint max;
+
+        if (rank >= 0 && read_uint(path, "max_brightness", &max) && max > 0) {
+            Backlight *bl = g_new0(Backlight, 1);
+            bl->name = g_strdup(name);
+            bl->dir = g_steal_pointer(&path);
+            bl->max = max;
+            bl->steps = MIN(max, G_MAXUINT16);
+            g_ptr_array_add(found[rank], bl);
+        }
+        g_free(type);
+        g_free(path);
+    }
+    g_dir_close(dir);
+
+    guint added = 0;
+    for (guint rank = 0; rank < G_N_ELEMENTS(found); rank++) {
+        /* Lesser interfaces to a panel that is already on the list are dropped */
+        gboolean wanted = added == 0;
+
+        for (guint i = 0; i < found[rank]->len; i++) {
+            Backlight *bl = g_ptr_array_index(found[rank], i);
+
+            if (!wanted) {
+                g_free(bl->name);
+                g_free(bl->dir);
+                g_free(bl);
+                continue;
+            }
+
+            dmi_display *disp = dmi_display_new(&backlight_backend, bl);
+            backlight_fill_info(disp, bl);
+            dmi_display_list_append(dlist, disp);
+            added++;
+
+            g_print("Backlight %s: %u steps\n", bl->name, bl->steps);
+        }
+        g_ptr_array_free(found[rank], TRUE);
+    }
+
+    return added;
+}
@@ -0,0 +1,17 @@
+#ifndef DMI_BACKLIGHT_H
+#define DMI_BACKLIGHT_H
+
+#include "dmi-api.h"
+
+/*
+ * Internal panels through the kernel's /sys/class/backlight. A laptop panel never answers
+ * DDC/CI, so it joins the display list as a display with brightness only and the "Internal
+ * DisplayPort" input. Writes go straight to sysfs when the file is writable, and otherwise
+ * through logind's SetBrightness, which lets the session user change the backlight without
+ * udev rules. Either way a write costs a fraction of a DDC transaction.
+ */
+
+/* Appends one display per internal backlight and returns how many were added */
+guint dmi_backlight_list_append(dmi_display_list *dlist);
+
+#endif
@@ -0,0 +1,320 @@
+#include "dmi-broker.h"
+#include "dmi-sched.h"
+
+#include <gio/gunixsocketaddress.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Requests of one client on the buses at once; the next header is read once one returns */
+#define BROKER_MAX_IN_FLIGHT 8
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-BROKER] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    guint ref;
+    GSocketConnection *conn;
+    GInputStream *in;
+    GOutputStream *out;
+    GQueue replies;
+    GBytes *writing;
+    gboolean closed;
+    guint in_flight;
+    gboolean read_paused;
+    dmi_broker_msg req;
+} BrokerClient;
+
+typedef struct {
+    BrokerClient *client;
+    dmi_broker_msg msg;
+    dmi_broker_item items[DMI_BROKER_MAX_ITEMS];
+} BrokerJob;
+
+static GSocketService *service = NULL;
+static char *socket_path = NULL;
+static dmi_display_list *broker_dlist = NULL;
+
+static void client_read_header(BrokerClient *client);
+static void client_read_next(BrokerClient *client);
+
+static BrokerClient *client_ref(BrokerClient *client) {
+    client->ref++;
+    return client;
+}
+
+static void client_unref(BrokerClient *client) {
+    if (--client->ref > 0) return;
+
+    DEBUG_PRINT("Client gone\n");
+    g_queue_clear_full(&client->replies, (GDestroyNotify)g_bytes_unref);
+    g_io_stream_close(G_IO_STREAM(client->conn), NULL, NULL);
+    g_object_unref(client->conn);
+    g_free(client);
+}
+
+static void client_close(BrokerClient *client) {
+    client->closed = TRUE;
+    g_queue_clear_full(&client->replies, (GDestroyNotify)g_bytes_unref);
+}
+
+static void client_flush(BrokerClient *client);
+
+static void client_write_done(GObject *source, GAsyncResult *res, gpointer data) {
+    BrokerClient *client = data;
+    GError *error = NULL;
+
+    if (!g_output_stream_write_all_finish(G_OUTPUT_STREAM(source), res, NULL, &error)) {
+        DEBUG_PRINT("Write failed: %s\n", error->message);
+        g_error_free(error);
+        client_close(client);
+    }
+
+    g_clear_pointer(&client->writing, g_bytes_unref);
+    client_flush(client);
+    client_unref(client);
+}
+
+/* One write in flight per client; the rest wait in order */
+static void client_flush(BrokerClient *client) {
+    if (client->closed || client->writing || g_queue_is_empty(&client->replies)) return;
+
+    client->writing = g_queue_pop_head(&client->replies);
+
+    gsize size;
+    const void *buf = g_bytes_get_data(client->writing, &size);
+    g_output_stream_write_all_async(client->out, buf, size, G_PRIORITY_DEFAULT, NULL,
+                                    client_write_done, client_ref(client));
+}
+
+static void client_reply(BrokerClient *client, const dmi_broker_msg *msg,
+                         const void *payload, gsize payload_size) {
+    if (client->closed) return;
+
+    GByteArray *buf = g_byte_array_sized_new(sizeof(*msg) + payload_size);
+    g_byte_array_append(buf, (const guint8 *)msg, sizeof(*msg));
+    if (payload_size > 0) g_byte_array_append(buf, payload, payload_size);
+
+    g_queue_push_tail(&client->replies, g_byte_array_free_to_bytes(buf));
+    client_flush(client);
+}
+
+static void broker_job(dmi_display *disp, gpointer data) {
+    BrokerJob *job = data;
+    dmi_broker_msg *msg = &job->msg;
+
+    msg->status = 0;
+
+    if (msg->op == DMI_BROKER_GET) {
+        for (guint i = 0; i < msg->n_items; i++) {
+            dmi_broker_item *item = &job->items[i];
+            int rc = dmi_display_read_vcp(disp, item->code, &item->value, &item->max, NULL);
+
+            item->status = rc;
+            if (rc != 0 && msg->status == 0) msg->status = rc;
+        }
+    } else if (msg->n_items == 1) {
+        dmi_broker_item *item = &job->items[0];
+
+        msg->status = dmi_display_set_vcp_value(disp, item->code, item->value, NULL);
+        item->status = msg->status;
+    } else {
+        dmi_vcp_write writes[DMI_BROKER_MAX_ITEMS];
+        for (guint i = 0; i < msg->n_items; i++) {
+            writes[i].code = job->items[i].code;
+            writes[i].value = job->items[i].value;
+        }
+
+        msg->status = dmi_display_set_vcp_batch(disp, writes, msg->n_items, NULL);
+        for (guint i = 0; i < msg->n_items; i++) job->items[i].status = msg->status;
+    }
+}
+
+static gboolean broker_job_done(gpointer data) {
+    BrokerJob *job = data;
+
+    BrokerClient *client = job->client;
+
+    client_reply(client, &job->msg, job->items, job->msg.n_items * sizeof(dmi_broker_item));
+    client->in_flight--;
+    if (client->read_paused) {
+        client->read_paused = FALSE;
+        client_read_next(client);
+    }
+    client_unref(client);
+    g_free(job);
+    return G_SOURCE_REMOVE;
+}
+
+static void broker_job_finish(gpointer data) {
+    g_idle_add(broker_job_done, data);
+}
+
+static void client_reply_list(BrokerClient *client, dmi_broker_msg *msg) {
+    guint ct = broker_dlist->ct;
+    char *ids = g_malloc0((gsize)ct * DMI_DISPLAY_ID_LEN);
+
+    for (guint i = 0; i < ct; i++) {
+        g_strlcpy(ids + i * DMI_DISPLAY_ID_LEN, dmi_display_list_get(broker_dlist, i)->id,
+                  DMI_DISPLAY_ID_LEN);
+    }
+
+    msg->status = ct;
+    msg->n_items = 0;
+    client_reply(client, msg, ids, (gsize)ct * DMI_DISPLAY_ID_LEN);
+    g_free(ids);
+}
+
+static void client_dispatch(BrokerClient *client, BrokerJob *job) {
+    dmi_broker_msg *msg = &job->msg;
+    dmi_display *disp = dmi_display_list_get(broker_dlist, msg->display);
+
+    if (msg->op == DMI_BROKER_LIST) {
+        client_reply_list(client, msg);
+        g_free(job);
+        return;
+    }
+
+    if (!disp || msg->n_items == 0 || (msg->op != DMI_BROKER_GET && msg->op != DMI_BROKER_SET)) {
+        msg->status = DMI_STATUS_ERROR;
+        msg->n_items = 0;
+        client_reply(client, msg, NULL, 0);
+        g_free(job);
+        return;
+    }
+
+    /* What a job dropped with its display or at shutdown answers; broker_job overwrites it */
+    msg->status = DMI_STATUS_CANCELLED;
+    for (guint i = 0; i < msg->n_items; i++) job->items[i].status = DMI_STATUS_CANCELLED;
+
+    /* Key 0: every request needs its own reply, so nothing is coalesced away. Background, so
+     * a busy client never holds back the user's own slider writes. */
+    job->client = client_ref(client);
+    client->in_flight++;
+    dmi_sched_submit(disp, DMI_SCHED_BACKGROUND, 0, broker_job, job, broker_job_finish);
+}
+
+static void client_read_items_done(GObject *source, GAsyncResult *res, gpointer data) {
+    BrokerJob *job = data;
+    BrokerClient *client = job->client;
+    gsize size = job->msg.n_items * sizeof(dmi_broker_item);
+    gsize read = 0;
+
+    job->client = NULL;
+
+    if (!g_input_stream_read_all_finish(G_INPUT_STREAM(source), res, &read, NULL) ||
+        read < size) {
+        g_free(job);
+        client_unref(client);
+        return;
+    }
+
+    client_dispatch(client, job);
+    client_read_next(client);
+    client_unref(client);
+}
+
+static void client_read_header_done(GObject *source, GAsyncResult *res, gpointer data) {
+    BrokerClient *client = data;
+    gsize read = 0;
+
+    if (!g_input_stream_read_all_finish(G_INPUT_STREAM(source), res, &read, NULL) ||
+        read < sizeof(client->req) || client->req.n_items > DMI_BROKER_MAX_ITEMS) {
+        client_unref(client);
+        return;
+    }
+
+    BrokerJob *job = g_new0(BrokerJob, 1);
+    job->msg = client->req;
+
+    if (job->msg.n_items == 0) {
+        client_dispatch(client, job);
+        client_read_next(client);
+        client_unref(client);
+        return;
+    }
+
+    /* The read holds the connection's reference until the items arrive */
+    job->client = client;
+    g_input_stream_read_all_async(client->in, job->items,
+                                  job->msg.n_items * sizeof(dmi_broker_item), G_PRIORITY_DEFAULT,
+                                  NULL, client_read_items_done, job);
+}
+
+static void client_read_header(BrokerClient *client) {
+    /* Pipelining: the next request is read while earlier ones are still on the bus */
+    g_input_stream_read_all_async(client->in, &client->req, sizeof(client->req),
+                                  G_PRIORITY_DEFAULT, NULL, client_read_header_done,
+                                  client_ref(client));
+}
+
+/* A client with its pipeline full is not read from until one of its requests returns */
+static void client_read_next(BrokerClient *client) {
+    if (client->in_flight >= BROKER_MAX_IN_FLIGHT) {
+        DEBUG_PRINT("Client has %u requests in flight, pausing\n", client->in_flight);
+        client->read_paused = TRUE;
+        return;
+    }
+    client_read_header(client);
+}
+
+static gboolean on_incoming(GSocketService *svc, GSocketConnection *conn, GObject *source,
+                            gpointer user_data) {
+    BrokerClient *client = g_new0(BrokerClient, 1);
+    client->ref = 1;
+    client->conn = g_object_ref(conn);
+    client->in = g_io_stream_get_input_stream(G_IO_STREAM(conn));
+    client->out = g_io_stream_get_output_stream(G_IO_STREAM(conn));
+    g_queue_init(&client->replies);
+
+    DEBUG_PRINT("Client connected\n");
+    client_read_header(client);
+    client_unref(client);
+    return TRUE;
+}
+
+gboolean dmi_broker_start(const char *socket_name, dmi_display_list *dlist) {
+    if (service || !socket_name || !dlist) return FALSE;
+
+    socket_path = g_build_filename(g_get_user_runtime_dir(), socket_name, NULL);
+    /* Only the primary instance gets here, and simulated runs have a socket of their own, so
+     * anything at the path is stale */
+    unlink(socket_path);
+
+    GSocketAddress *addr = g_unix_socket_address_new(socket_path);
+    GError *error = NULL;
+
+    service = g_socket_service_new();
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), addr, G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &error)) {
+        g_printerr("Failed to listen on %s: %s\n", socket_path, error->message);
+        g_error_free(error);
+        g_object_unref(addr);
+        g_clear_object(&service);
+        g_clear_pointer(&socket_path, g_free);
+        return FALSE;
+    }
+    g_object_unref(addr);
+
+    broker_dlist = dlist;
+    g_signal_connect(service, "incoming", G_CALLBACK(on_incoming), NULL);
+    g_socket_service_start(service);
+
+    g_print("Serving DDC requests on %s\n", socket_path);
+    return TRUE;
+}
+
+void dmi_broker_stop(void) {
+    if (!service) return;
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_clear_object(&service);
+
+    unlink(socket_path);
+    g_clear_pointer(&socket_path, g_free);
+    broker_dlist = NULL;
+}
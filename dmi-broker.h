@@ -0,0 +1,61 @@
+#ifndef DMI_BROKER_H
+#define DMI_BROKER_H
+
+#include "dmi-api.h"
+
+/*
+ * DDC broker: with --broker the running instance serves VCP requests on the Unix socket
+ * $XDG_RUNTIME_DIR/dmi-gtk.sock (dmi-gtk-sim.sock for --simulate runs) through its own open
+ * handles and per-bus scheduler, so other tools never re-detect displays or collide on the
+ * bus.
+ *
+ * Every request is a dmi_broker_msg header followed by n_items dmi_broker_item entries,
+ * and gets exactly one reply in the same format. Clients may send many requests without
+ * waiting; replies for different buses can come back out of order and are matched by tag.
+ * At most 8 requests per client are on the buses at once; the socket is not read further
+ * until one of them returns. Requests queue behind the user's own changes in the UI.
+ *
+ *   LIST  n_items 0; reply status is the display count and is followed by that many
+ *         DMI_DISPLAY_ID_LEN byte, NUL padded display ids (the index is the display number)
+ *   GET   each item names a code; the reply fills in value and max
+ *   SET   items carry code and value; several items are written as one batch
+ *
+ * status is 0 or a negative dmi-api / DDCA status. A request dropped before it reached the
+ * bus, because its display went away or the broker shut down, is answered with
+ * DMI_STATUS_CANCELLED in the header and every item. All fields are host-endian.
+ */
+
+#define DMI_BROKER_SOCKET "dmi-gtk.sock"
+#define DMI_BROKER_SIM_SOCKET "dmi-gtk-sim.sock"
+#define DMI_BROKER_MAX_ITEMS 16
+
+enum {
+    DMI_BROKER_LIST = 1,
+    DMI_BROKER_GET = 2,
+    DMI_BROKER_SET = 3,
+};
+
+typedef struct {
+    guint8 op;
+    guint8 n_items;
+    guint16 display;
+    guint32 tag;
+    gint32 status;
+    guint32 reserved;
+} dmi_broker_msg;
+
+typedef struct {
+    guint8 code;
+    guint8 reserved;
+    guint16 value;
+    guint16 max;
+    gint16 status;
+} dmi_broker_item;
+
+G_STATIC_ASSERT(sizeof(dmi_broker_msg) == 16);
+G_STATIC_ASSERT(sizeof(dmi_broker_item) == 8);
+
+gboolean dmi_broker_start(const char *socket_name, dmi_display_list *dlist);
+void dmi_broker_stop(void);
+
+#endif
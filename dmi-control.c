@@ -0,0 +1,118 @@
+#include "dmi-control.h"
+
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-CONTROL] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+struct _dmi_control_request {
+    GSocketConnection *conn;
+    GDataInputStream *in;
+};
+
+static GSocketService *service = NULL;
+static char *socket_path = NULL;
+static dmi_control_handler control_handler = NULL;
+static gpointer control_data = NULL;
+
+static void request_free(dmi_control_request *req) {
+    g_io_stream_close(G_IO_STREAM(req->conn), NULL, NULL);
+    g_object_unref(req->in);
+    g_object_unref(req->conn);
+    g_free(req);
+}
+
+/* A reply is a few bytes into an empty socket buffer, so it is written in place. That also
+ * gets it out before a "quit" stops the main loop. */
+void dmi_control_reply(dmi_control_request *req, const char *reply) {
+    if (!req) return;
+
+    DEBUG_PRINT("Reply: %s\n", reply);
+    char *line = g_strconcat(reply, "\n", NULL);
+
+    GOutputStream *out = g_io_stream_get_output_stream(G_IO_STREAM(req->conn));
+    g_output_stream_write_all(out, line, strlen(line), NULL, NULL, NULL);
+
+    g_free(line);
+    request_free(req);
+}
+
+static void command_read(GObject *source, GAsyncResult *res, gpointer data) {
+    dmi_control_request *req = data;
+    gsize len = 0;
+    char *line = g_data_input_stream_read_line_finish(req->in, res, &len, NULL);
+
+    if (!line || len > DMI_CONTROL_MAX_LINE || !control_handler) {
+        g_free(line);
+        request_free(req);
+        return;
+    }
+
+    DEBUG_PRINT("Command: %s\n", line);
+    control_handler(g_strstrip(line), req, control_data);
+    g_free(line);
+}
+
+static gboolean on_incoming(GSocketService *svc, GSocketConnection *conn, GObject *source,
+                            gpointer user_data) {
+    dmi_control_request *req = g_new0(dmi_control_request, 1);
+    req->conn = g_object_ref(conn);
+    req->in = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(conn)));
+
+    /* High priority: this is the hotkey path, it should not queue behind redraws */
+    g_data_input_stream_read_line_async(req->in, G_PRIORITY_HIGH, NULL, command_read, req);
+    return TRUE;
+}
+
+gboolean dmi_control_start(const char *socket_name, dmi_control_handler handler,
+                           gpointer user_data) {
+    if (service || !socket_name || !handler) return FALSE;
+
+    socket_path = g_build_filename(g_get_user_runtime_dir(), socket_name, NULL);
+    /* Only the primary instance gets here, so anything at the path is stale */
+    unlink(socket_path);
+
+    GSocketAddress *addr = g_unix_socket_address_new(socket_path);
+    GError *error = NULL;
+
+    service = g_socket_service_new();
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), addr, G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &error)) {
+        g_printerr("Failed to listen on %s: %s\n", socket_path, error->message);
+        g_error_free(error);
+        g_object_unref(addr);
+        g_clear_object(&service);
+        g_clear_pointer(&socket_path, g_free);
+        return FALSE;
+    }
+    g_object_unref(addr);
+
+    control_handler = handler;
+    control_data = user_data;
+    g_signal_connect(service, "incoming", G_CALLBACK(on_incoming), NULL);
+    g_socket_service_start(service);
+
+    DEBUG_PRINT("Listening on %s\n", socket_path);
+    return TRUE;
+}
+
+void dmi_control_stop(void) {
+    if (!service) return;
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_clear_object(&service);
+
+    unlink(socket_path);
+    g_clear_pointer(&socket_path, g_free);
+    control_handler = NULL;
+    control_data = NULL;
+}
@@ -0,0 +1,33 @@
+#ifndef DMI_CONTROL_H
+#define DMI_CONTROL_H
+
+#include <glib.h>
+
+/*
+ * Control socket: the primary instance listens on $XDG_RUNTIME_DIR/dmi-gtk.ctl (simulated
+ * runs on dmi-gtk-sim.ctl) so that dmi-activate can raise the window without loading GTK or
+ * libddcutil. A request is one command line, the reply one status line:
+ *
+ *   activate   show the window            -> "shown" once it has drawn a frame
+ *   toggle     show or hide the window    -> "shown" or "hidden"
+ *   quit       exit the instance          -> "ok"
+ *
+ * Anything else, or a window that cannot be shown, is answered with "error".
+ */
+
+#define DMI_CONTROL_SOCKET "dmi-gtk.ctl"
+#define DMI_CONTROL_SIM_SOCKET "dmi-gtk-sim.ctl"
+#define DMI_CONTROL_MAX_LINE 64
+
+typedef struct _dmi_control_request dmi_control_request;
+
+/* Called on the main loop; the handler must answer every request exactly once */
+typedef void (*dmi_control_handler)(const char *command, dmi_control_request *req,
+                                    gpointer user_data);
+
+gboolean dmi_control_start(const char *socket_name, dmi_control_handler handler,
+                           gpointer user_data);
+void dmi_control_reply(dmi_control_request *req, const char *reply);
+void dmi_control_stop(void);
+
+#endif
@@ -0,0 +1,412 @@
+#include "dmi-curve.h"
+#include "dmi-sched.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VCP_BRIGHTNESS 0x10
+#define VCP_CTEMP 0x14
+
+#define CURVE_DEFAULT_DEADBAND 5
+#define CURVE_DEFAULT_STAGGER_MS 750
+#define CURVE_DEFAULT_PAUSE_MIN 120
+#define CURVE_MAX_SLEEP_MIN 30
+#define MINUTES_PER_DAY (24 * 60)
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-CURVE] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    int minute;
+    int value;
+} CurvePoint;
+
+typedef struct {
+    dmi_display *disp;
+    GArray *brightness;
+    GArray *ctemp;
+    int last_brightness;
+    int last_ctemp;
+    gint64 paused_until;
+    /* A read of the brightness maximum is queued */
+    gboolean reading;
+    /* That read failed and is not repeated; a probe by the window may still fill the cache */
+    gboolean no_brightness;
+} DisplayCurve;
+
+typedef struct {
+    dmi_display *disp;
+    guint8 code;
+    guint16 value;
+} CurveWrite;
+
+typedef struct {
+    dmi_display *disp;
+    int rc;
+} CurveRead;
+
+static GPtrArray *curves = NULL;
+static int deadband = CURVE_DEFAULT_DEADBAND;
+static int stagger_ms = CURVE_DEFAULT_STAGGER_MS;
+static int pause_min = CURVE_DEFAULT_PAUSE_MIN;
+static guint curve_timeout_id = 0;
+
+static void curve_schedule_next(void);
+
+static gint compare_points(gconstpointer a, gconstpointer b) {
+    return ((const CurvePoint *)a)->minute - ((const CurvePoint *)b)->minute;
+}
+
+static GArray *parse_points(GKeyFile *kf, const char *group, const char *key) {
+    gchar **items = g_key_file_get_string_list(kf, group, key, NULL, NULL);
+    if (!items) return NULL;
+
+    GArray *points = g_array_new(FALSE, FALSE, sizeof(CurvePoint));
+    for (gchar **it = items; *it; it++) {
+        int hour, min, value;
+        if (sscanf(*it, " %d:%d=%i", &hour, &min, &value) != 3 || hour < 0 || hour > 23 ||
+            min < 0 || min > 59 || value < 0) {
+            g_printerr("Ignoring invalid curve point '%s' in [%s]\n", *it, group);
+            continue;
+        }
+        CurvePoint p = {.minute = hour * 60 + min, .value = value};
+        g_array_append_val(points, p);
+    }
+    g_strfreev(items);
+
+    if (points->len == 0) {
+        g_array_free(points, TRUE);
+        return NULL;
+    }
+
+    g_array_sort(points, compare_points);
+    return points;
+}
+
+static int eval_linear(GArray *points, double minute) {
+    if (!points) return -1;
+
+    const CurvePoint *p = (const CurvePoint *)points->data;
+    guint n = points->len;
+    if (n == 1) return p[0].value;
+
+    /* Find the segment [a, b) containing minute, wrapping around midnight */
+    const CurvePoint *a = &p[n - 1];
+    const CurvePoint *b = &p[0];
+    for (guint i = 0; i + 1 < n; i++) {
+        if (minute >= p[i].minute && minute < p[i + 1].minute) {
+            a = &p[i];
+            b = &p[i + 1];
+            break;
+        }
+    }
+
+    double start = a->minute;
+    double end = b->minute;
+    double t = minute;
+    if (end <= start) end += MINUTES_PER_DAY;
+    if (t < start) t += MINUTES_PER_DAY;
+
+    double frac = (t - start) / (end - start);
+    return (int)(a->value + (b->value - a->value) * frac + 0.5);
+}
+
+static int eval_step(GArray *points, double minute) {
+    if (!points) return -1;
+
+    const CurvePoint *p = (const CurvePoint *)points->data;
+    int value = p[points->len - 1].value;
+    for (guint i = 0; i < points->len; i++) {
+        if (p[i].minute <= minute) value = p[i].value;
+    }
+    return value;
+}
+
+static double local_minute(void) {
+    GDateTime *now = g_date_time_new_now_local();
+    double minute = g_date_time_get_hour(now) * 60 + g_date_time_get_minute(now) +
+                    g_date_time_get_seconds(now) / 60.0;
+    g_date_time_unref(now);
+    return minute;
+}
+
+static double wrap_minute(double minute) {
+    while (minute >= MINUTES_PER_DAY) minute -= MINUTES_PER_DAY;
+    return minute;
+}
+
+/* Targets are turned into the monitor's own steps, so nothing is due until the maximum is
+ * in the cache; 0 while it is not */
+static guint16 curve_brightness_max(DisplayCurve *c) {
+    guint16 cur, max = 0;
+
+    if (c->brightness) dmi_display_cached_vcp(c->disp, VCP_BRIGHTNESS, &cur, &max);
+    return max;
+}
+
+static gboolean curve_wants_brightness(DisplayCurve *c, double minute, int *target) {
+    *target = -1;
+    if (curve_brightness_max(c) == 0) return FALSE;
+
+    *target = eval_linear(c->brightness, minute);
+    if (*target < 0) return FALSE;
+    if (c->last_brightness < 0) return TRUE;
+
+    int delta = ABS(*target - c->last_brightness);
+    if (delta >= deadband) return TRUE;
+
+    /* Settle onto plateaus exactly instead of stopping just inside the deadband */
+    return delta > 0 && eval_linear(c->brightness, wrap_minute(minute + 1)) == *target;
+}
+
+static gboolean curve_wants_ctemp(DisplayCurve *c, double minute, int *preset) {
+    *preset = eval_step(c->ctemp, minute);
+    return *preset >= 0 && *preset != c->last_ctemp;
+}
+
+static void curve_write_job(dmi_display *disp, gpointer data) {
+    CurveWrite *w = data;
+
+    int rc = (w->code == VCP_BRIGHTNESS) ? dmi_display_set_brightness(disp, w->value, NULL)
+                                         : dmi_display_set_vcp_value(disp, w->code, w->value, NULL);
+    if (rc != 0) {
+        g_printerr("Scheduled write of VCP 0x%02x failed: %d\n", w->code, rc);
+    }
+}
+
+static gboolean curve_write_submit(gpointer data) {
+    CurveWrite *w = data;
+
+    dmi_sched_submit(w->disp, DMI_SCHED_BACKGROUND, DMI_SCHED_KEY_VCP(w->code), curve_write_job,
+                     w, g_free);
+    return G_SOURCE_REMOVE;
+}
+
+static void curve_write(DisplayCurve *c, guint8 code, guint16 value, guint slot) {
+    CurveWrite *w = g_new0(CurveWrite, 1);
+    w->disp = c->disp;
+    w->code = code;
+    w->value = value;
+
+    DEBUG_PRINT("%s: VCP 0x%02x -> %u (slot %u)\n", c->disp->info.model_name, code, value, slot);
+
+    if (slot == 0 || stagger_ms <= 0) {
+        curve_write_submit(w);
+    } else {
+        g_timeout_add(slot * stagger_ms, curve_write_submit, w);
+    }
+}
+
+static void curve_read_job(dmi_display *disp, gpointer data) {
+    CurveRead *r = data;
+    r->rc = dmi_display_get_brightness(disp, NULL);
+}
+
+static gboolean curve_read_done(gpointer data) {
+    CurveRead *r = data;
+
+    for (guint i = 0; curves && i < curves->len; i++) {
+        DisplayCurve *c = g_ptr_array_index(curves, i);
+        if (c->disp != r->disp) continue;
+
+        c->reading = FALSE;
+        if (r->rc != 0) {
+            g_printerr("%s: brightness unreadable (%d), curve waits until it is known\n",
+                       c->disp->info.model_name, r->rc);
+            c->no_brightness = TRUE;
+        }
+        curve_schedule_next();
+        break;
+    }
+
+    g_free(r);
+    return G_SOURCE_REMOVE;
+}
+
+/* Runs for dropped jobs too, which count as failed reads */
+static void curve_read_finish(gpointer data) {
+    g_idle_add(curve_read_done, data);
+}
+
+/* For a curve set up before anything probed the display, e.g. while the window is hidden */
+static void curve_read_max(DisplayCurve *c) {
+    if (!c->brightness || c->no_brightness || c->reading) return;
+
+    CurveRead *r = g_new0(CurveRead, 1);
+    r->disp = c->disp;
+    r->rc = DMI_STATUS_CANCELLED;
+    c->reading = TRUE;
+    dmi_sched_submit(c->disp, DMI_SCHED_BACKGROUND, 0, curve_read_job, r, curve_read_finish);
+}
+
+static gboolean curve_tick(gpointer data) {
+    curve_timeout_id = 0;
+
+    gint64 now = g_get_monotonic_time();
+    double minute = local_minute();
+    guint slot = 0;
+
+    for (guint i = 0; i < curves->len; i++) {
+        DisplayCurve *c = g_ptr_array_index(curves, i);
+        if (c->paused_until > now) continue;
+
+        int target;
+        if (curve_wants_brightness(c, minute, &target)) {
+            guint16 max = curve_brightness_max(c);
+            guint16 raw = (target * max + 50) / 100;
+            curve_write(c, VCP_BRIGHTNESS, MIN(raw, max), slot++);
+            c->last_brightness = target;
+        } else if (c->brightness && curve_brightness_max(c) == 0) {
+            curve_read_max(c);
+        }
+
+        int preset;
+        if (curve_wants_ctemp(c, minute, &preset)) {
+            curve_write(c, VCP_CTEMP, preset, slot++);
+            c->last_ctemp = preset;
+        }
+    }
+
+    curve_schedule_next();
+    return G_SOURCE_REMOVE;
+}
+
+static void curve_schedule_next(void) {
+    if (curve_timeout_id > 0) {
+        g_source_remove(curve_timeout_id);
+        curve_timeout_id = 0;
+    }
+    if (!curves || curves->len == 0) return;
+
+    gint64 now = g_get_monotonic_time();
+    double base = local_minute();
+    guint sleep_sec = CURVE_MAX_SLEEP_MIN * 60;
+
+    /* Walk forward a minute at a time and sleep until the first write is due. The walk is
+     * cheap arithmetic; the point is to avoid waking up just to find nothing to do. */
+    for (int k = 1; k <= CURVE_MAX_SLEEP_MIN; k++) {
+        double minute = wrap_minute(base + k);
+        gboolean due = FALSE;
+
+        for (guint i = 0; i < curves->len && !due; i++) {
+            DisplayCurve *c = g_ptr_array_index(curves, i);
+            int target;
+
+            if (c->paused_until > now) {
+                due = c->paused_until <= now + (gint64)k * 60 * G_USEC_PER_SEC;
+            } else {
+                due = curve_wants_brightness(c, minute, &target) ||
+                      curve_wants_ctemp(c, minute, &target);
+            }
+        }
+
+        if (due) {
+            sleep_sec = k * 60;
+            break;
+        }
+    }
+
+    DEBUG_PRINT("Next curve evaluation in %u s\n", sleep_sec);
+    curve_timeout_id = g_timeout_add_seconds(sleep_sec, curve_tick, NULL);
+}
+
+static void display_curve_free(gpointer data) {
+    DisplayCurve *c = data;
+
+    if (c->brightness) g_array_free(c->brightness, TRUE);
+    if (c->ctemp) g_array_free(c->ctemp, TRUE);
+    g_free(c);
+}
+
+void dmi_curve_init(dmi_display_list *dlist) {
+    if (curves || !dlist) return;
+
+    char *path = g_build_filename(g_get_user_config_dir(), "dmi-gtk", "curves.ini", NULL);
+    GKeyFile *kf = g_key_file_new();
+
+    if (!g_key_file_load_from_file(kf, path, G_KEY_FILE_NONE, NULL)) {
+        g_key_file_free(kf);
+        g_free(path);
+        return;
+    }
+
+    if (g_key_file_has_key(kf, "curve", "deadband", NULL)) {
+        deadband = MAX(1, g_key_file_get_integer(kf, "curve", "deadband", NULL));
+    }
+    if (g_key_file_has_key(kf, "curve", "stagger-ms", NULL)) {
+        stagger_ms = MAX(0, g_key_file_get_integer(kf, "curve", "stagger-ms", NULL));
+    }
+    if (g_key_file_has_key(kf, "curve", "manual-pause-min", NULL)) {
+        pause_min = MAX(0, g_key_file_get_integer(kf, "curve", "manual-pause-min", NULL));
+    }
+
+    curves = g_ptr_array_new_with_free_func(display_curve_free);
+
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+
+        char group[64];
+        snprintf(group, sizeof(group), "display %s", disp->id);
+        if (!g_key_file_has_group(kf, group)) continue;
+
+        DisplayCurve *c = g_new0(DisplayCurve, 1);
+        c->disp = disp;
+        c->brightness = parse_points(kf, group, "brightness");
+        c->ctemp = parse_points(kf, group, "ctemp");
+        c->last_brightness = -1;
+        c->last_ctemp = -1;
+
+        if (!c->brightness && !c->ctemp) {
+            display_curve_free(c);
+            continue;
+        }
+
+        g_ptr_array_add(curves, c);
+        g_print("Following brightness curve for %s\n", disp->info.model_name);
+    }
+
+    g_key_file_free(kf);
+    g_free(path);
+
+    if (curves->len > 0) {
+        curve_timeout_id = g_idle_add(curve_tick, NULL);
+    }
+}
+
+void dmi_curve_pause(dmi_display *disp) {
+    if (!curves) return;
+
+    for (guint i = 0; i < curves->len; i++) {
+        DisplayCurve *c = g_ptr_array_index(curves, i);
+        if (c->disp != disp) continue;
+
+        gint64 now = g_get_monotonic_time();
+        gboolean was_paused = c->paused_until > now;
+
+        c->paused_until = now + (gint64)pause_min * 60 * G_USEC_PER_SEC;
+        /* Re-apply the curve in full once the pause ends */
+        c->last_brightness = -1;
+        c->last_ctemp = -1;
+
+        /* Called on every step of a drag; the wakeup at the old end of the pause finds it
+         * extended and sleeps again */
+        if (!was_paused) curve_schedule_next();
+        return;
+    }
+}
+
+void dmi_curve_shutdown(void) {
+    if (curve_timeout_id > 0) {
+        g_source_remove(curve_timeout_id);
+        curve_timeout_id = 0;
+    }
+    if (curves) {
+        g_ptr_array_free(curves, TRUE);
+        curves = NULL;
+    }
+}
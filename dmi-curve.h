@@ -0,0 +1,31 @@
+#ifndef DMI_CURVE_H
+#define DMI_CURVE_H
+
+#include "dmi-api.h"
+
+/*
+ * Time-of-day brightness and colour preset curves, read from
+ * $XDG_CONFIG_HOME/dmi-gtk/curves.ini:
+ *
+ *   [curve]
+ *   deadband=5            # percent the target must move before a write is issued
+ *   stagger-ms=750        # spacing between displays that change at the same time
+ *   manual-pause-min=120  # how long a manual change suspends the curve for a display
+ *
+ *   [display edid-0123456789abcdef]
+ *   brightness=07:00=35;09:30=80;18:00=70;22:30=20
+ *   ctemp=07:00=0x05;20:00=0x0b
+ *
+ * Displays are matched by the identity printed at startup. Brightness points are
+ * percentages interpolated linearly (wrapping at midnight), colour presets are steps. The
+ * engine sleeps until the next time the target leaves the deadband, so a display sees a
+ * handful of writes per hour.
+ */
+
+void dmi_curve_init(dmi_display_list *dlist);
+void dmi_curve_shutdown(void);
+
+/* Suspends the curve for disp after the user changed it by hand */
+void dmi_curve_pause(dmi_display *disp);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * libFuzzer entry point for the ddcutil text parsers. Every input is read line by line like
+ * a command's output and fed to the getvcp, capabilities and detect parsers at once. Results
+ * outside the ranges the callers rely on abort, so the fuzzer reports them like a crash.
+ * Built by `./build.sh fuzz`, which starts from the samples in fuzz/corpus.
+ */
+#include "dmi-parse.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_MAX_CODES 16
+
+static void check_string(const char *s, gsize size) {
+    if (!memchr(s, '\0', size)) abort();
+}
+
+static void check_detect(const dmi_parse_detect *found) {
+    if (found->bus < 0 || found->bus > G_MAXUINT16) abort();
+    if (!found->mfg[0] || !found->model[0]) abort();
+    check_string(found->mfg, sizeof(found->mfg));
+    check_string(found->model, sizeof(found->model));
+    check_string(found->sn, sizeof(found->sn));
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0) return 0;
+
+    FILE *fp = fmemopen((void *)data, size, "r");
+    if (!fp) return 0;
+
+    char line[DMI_PARSE_LINE_MAX];
+    dmi_parse_detect state, found;
+    dmi_parse_caps caps = {0};
+    int codes[FUZZ_MAX_CODES];
+
+    dmi_parse_detect_init(&state);
+
+    while (dmi_parse_read_line(fp, line, sizeof(line))) {
+        int value = dmi_parse_getvcp(line);
+        if (value < -1 || value > 0xFFFF) abort();
+
+        guint n = dmi_parse_caps_inputs(&caps, line, codes, FUZZ_MAX_CODES);
+        if (n > FUZZ_MAX_CODES) abort();
+        for (guint i = 0; i < n; i++) {
+            if (codes[i] < 0 || codes[i] > 0xFF) abort();
+        }
+
+        if (dmi_parse_detect_line(&state, line, &found)) check_detect(&found);
+    }
+    if (dmi_parse_detect_line(&state, NULL, &found)) check_detect(&found);
+
+    fclose(fp);
+    return 0;
+}
@@ -0,0 +1,344 @@
+#include "dmi-journal.h"
+#include "dmi-backend.h"
+#include "dmi-sched.h"
+#include "dmi-sim.h"
+
+#include <errno.h>
+#include <string.h>
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-JOURNAL] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    const dmi_journal_entry *entry;
+    gint64 issued_us;
+    gint64 done_us;
+} ReplayJob;
+
+static const char *const op_names[] = {"?", "get", "set", "caps"};
+
+static GMutex journal_lock;
+static dmi_journal_entry *ring = NULL;
+static guint ring_capacity = 0;
+static guint ring_head = 0;
+static guint ring_count = 0;
+static GPtrArray *journal_displays = NULL;
+static gint64 started_mono = 0;
+static gint64 started_real = 0;
+
+static dmi_journal_header replay_header;
+static dmi_journal_display *replay_displays = NULL;
+static dmi_journal_entry *replay_entries = NULL;
+static dmi_display_list *replay_dlist = NULL;
+static GApplication *replay_app = NULL;
+static guint replay_next = 0;
+static guint replay_done = 0;
+static gint64 replay_start = 0;
+static guint replay_count[G_N_ELEMENTS(op_names)];
+static gint64 replay_recorded_us[G_N_ELEMENTS(op_names)];
+static gint64 replay_replayed_us[G_N_ELEMENTS(op_names)];
+static gint64 replay_worst_delay = 0;
+static int replay_status = 0;
+
+void dmi_journal_start(guint capacity) {
+    if (ring || capacity == 0) return;
+
+    ring = g_new0(dmi_journal_entry, capacity);
+    ring_capacity = capacity;
+    journal_displays = g_ptr_array_new();
+    started_mono = g_get_monotonic_time();
+    started_real = g_get_real_time();
+}
+
+void dmi_journal_record(dmi_display *disp, guint8 op, guint8 code, guint16 value, guint16 max,
+                        int status, gint64 start_us) {
+    if (!ring || !disp) return;
+
+    dmi_journal_entry e = {
+        .time_us = start_us - started_mono,
+        .duration_us = (guint32)MIN(g_get_monotonic_time() - start_us, G_MAXUINT32),
+        .status = status,
+        .value = value,
+        .max = max,
+        .code = code,
+        .op = op,
+    };
+
+    g_mutex_lock(&journal_lock);
+
+    guint index;
+    if (!g_ptr_array_find(journal_displays, disp, &index)) {
+        index = journal_displays->len;
+        g_ptr_array_add(journal_displays, disp);
+    }
+    e.display = index;
+
+    ring[ring_head] = e;
+    ring_head = (ring_head + 1) % ring_capacity;
+    if (ring_count < ring_capacity) ring_count++;
+
+    g_mutex_unlock(&journal_lock);
+}
+
+char *dmi_journal_dump(GError **error) {
+    if (!ring) return NULL;
+
+    g_mutex_lock(&journal_lock);
+
+    dmi_journal_header header = {
+        .magic = DMI_JOURNAL_MAGIC,
+        .version = DMI_JOURNAL_VERSION,
+        .n_displays = journal_displays->len,
+        .n_entries = ring_count,
+        .started_us = started_real,
+    };
+
+    GByteArray *buf = g_byte_array_sized_new(sizeof(header) +
+                                             header.n_displays * sizeof(dmi_journal_display) +
+                                             header.n_entries * sizeof(dmi_journal_entry));
+    g_byte_array_append(buf, (const guint8 *)&header, sizeof(header));
+
+    /* Identities are copied now: early probes run before the display id is computed */
+    for (guint i = 0; i < journal_displays->len; i++) {
+        dmi_display *disp = g_ptr_array_index(journal_displays, i);
+        dmi_journal_display d = {.product = disp->info.product_code};
+
+        g_strlcpy(d.id, disp->id, sizeof(d.id));
+        g_strlcpy(d.model, disp->info.model_name, sizeof(d.model));
+        g_strlcpy(d.mfg, disp->info.mfg_id, sizeof(d.mfg));
+        g_byte_array_append(buf, (const guint8 *)&d, sizeof(d));
+    }
+
+    guint oldest = (ring_head + ring_capacity - ring_count) % ring_capacity;
+    for (guint i = 0; i < ring_count; i++) {
+        g_byte_array_append(buf, (const guint8 *)&ring[(oldest + i) % ring_capacity],
+                            sizeof(dmi_journal_entry));
+    }
+
+    g_mutex_unlock(&journal_lock);
+
+    char *dir = g_build_filename(g_get_user_cache_dir(), "dmi-gtk", NULL);
+    GDateTime *now = g_date_time_new_now_local();
+    char *name = g_date_time_format(now, "journal-%Y%m%d-%H%M%S.bin");
+    char *path = g_build_filename(dir, name, NULL);
+
+    gboolean ok = g_mkdir_with_parents(dir, 0700) == 0;
+    if (!ok) {
+        g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errno), "Cannot create %s: %s",
+                    dir, g_strerror(errno));
+    } else {
+        ok = g_file_set_contents(path, (const char *)buf->data, buf->len, error);
+    }
+
+    g_byte_array_free(buf, TRUE);
+    g_date_time_unref(now);
+    g_free(name);
+    g_free(dir);
+
+    if (!ok) g_clear_pointer(&path, g_free);
+    return path;
+}
+
+guint dmi_journal_replay_load(const char *path) {
+    char *data = NULL;
+    gsize len = 0;
+    GError *error = NULL;
+
+    if (!g_file_get_contents(path, &data, &len, &error)) {
+        g_printerr("Failed to read journal: %s\n", error->message);
+        g_error_free(error);
+        return 0;
+    }
+
+    dmi_journal_header header = {0};
+    if (len >= sizeof(header)) memcpy(&header, data, sizeof(header));
+
+    gsize displays_size = (gsize)header.n_displays * sizeof(dmi_journal_display);
+    gsize entries_size = (gsize)header.n_entries * sizeof(dmi_journal_entry);
+
+    if (header.magic != DMI_JOURNAL_MAGIC || header.version != DMI_JOURNAL_VERSION ||
+        header.n_displays == 0 || len != sizeof(header) + displays_size + entries_size) {
+        g_printerr("%s is not a dmi-gtk journal\n", path);
+        g_free(data);
+        return 0;
+    }
+
+    replay_header = header;
+    replay_displays = g_memdup2(data + sizeof(header), displays_size);
+    replay_entries = g_memdup2(data + sizeof(header) + displays_size, entries_size);
+    g_free(data);
+
+    for (guint i = 0; i < header.n_entries; i++) {
+        const dmi_journal_entry *e = &replay_entries[i];
+        if (e->display >= header.n_displays || e->op == 0 || e->op >= G_N_ELEMENTS(op_names)) {
+            g_printerr("Journal entry %u is corrupt\n", i);
+            g_clear_pointer(&replay_displays, g_free);
+            g_clear_pointer(&replay_entries, g_free);
+            return 0;
+        }
+    }
+
+    g_print("Replaying %u operations on %u displays from %s\n", header.n_entries,
+            header.n_displays, path);
+    return header.n_displays;
+}
+
+gboolean dmi_journal_replay_enabled(void) {
+    return replay_displays != NULL;
+}
+
+void dmi_journal_replay_prepare(dmi_display_list *dlist) {
+    if (!replay_displays || !dlist) return;
+
+    for (guint i = 0; i < dlist->ct && i < replay_header.n_displays; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+
+        g_strlcpy(disp->info.model_name, replay_displays[i].model, sizeof(disp->info.model_name));
+        /* The journal already holds the outcome of every operation the real model allowed */
+        disp->quirk = NULL;
+    }
+
+    /* Every feature the journal touched exists, with the first value the monitor reported.
+     * Runs on the main thread, so the cache is seeded directly instead of read back. */
+    for (guint pass = 0; pass < 2; pass++) {
+        guint8 op = pass == 0 ? DMI_JOURNAL_SET : DMI_JOURNAL_GET;
+
+        for (guint i = replay_header.n_entries; i-- > 0;) {
+            const dmi_journal_entry *e = &replay_entries[i];
+            if (e->op != op || e->status != 0) continue;
+
+            dmi_display *disp = dmi_display_list_get(dlist, e->display);
+            guint16 max = op == DMI_JOURNAL_GET ? e->max : 0xffff;
+            dmi_sim_set_feature(disp, e->code, e->value, max);
+            dmi_display_cache_store(disp, e->code, e->value, max);
+        }
+    }
+}
+
+static void replay_report(void) {
+    const dmi_journal_entry *first = &replay_entries[0];
+    const dmi_journal_entry *last = &replay_entries[replay_header.n_entries - 1];
+    double recorded = (last->time_us + last->duration_us - first->time_us) / 1e6;
+
+    g_print("replay: %u operations on %u displays, recorded over %.1f s, replayed in %.1f s\n",
+            replay_header.n_entries, replay_header.n_displays, recorded,
+            (g_get_monotonic_time() - replay_start) / 1e6);
+
+    for (guint op = 1; op < G_N_ELEMENTS(op_names); op++) {
+        if (replay_count[op] == 0) continue;
+
+        g_print("replay: %-4s %5u ops, recorded %.1f ms avg, replayed %.1f ms avg issue to done\n",
+                op_names[op], replay_count[op],
+                replay_recorded_us[op] / 1000.0 / replay_count[op],
+                replay_replayed_us[op] / 1000.0 / replay_count[op]);
+    }
+
+    g_print("replay: worst wait beyond the recorded duration %.1f ms\n",
+            replay_worst_delay / 1000.0);
+}
+
+static void replay_finish_all(void) {
+    if (replay_header.n_entries > 0) replay_report();
+    g_application_quit(replay_app);
+}
+
+static void replay_job(dmi_display *disp, gpointer data) {
+    ReplayJob *job = data;
+    const dmi_journal_entry *e = job->entry;
+    guint16 cur, max;
+    GArray *inputs = NULL;
+
+    dmi_sim_script_next(disp, e->duration_us, e->status);
+
+    switch (e->op) {
+    case DMI_JOURNAL_GET:
+        dmi_display_read_vcp(disp, e->code, &cur, &max, NULL);
+        break;
+    case DMI_JOURNAL_SET:
+        dmi_display_set_vcp_value(disp, e->code, e->value, NULL);
+        break;
+    case DMI_JOURNAL_CAPS:
+        /* Served from the cache after the first fetch, as in the app */
+        if (dmi_display_get_supported_inputs(disp, &inputs, NULL) == 0) {
+            g_array_free(inputs, TRUE);
+        }
+        break;
+    }
+
+    dmi_sim_script_clear(disp);
+    job->done_us = g_get_monotonic_time();
+}
+
+static gboolean replay_job_done(gpointer data) {
+    ReplayJob *job = data;
+    const dmi_journal_entry *e = job->entry;
+    gint64 took = job->done_us - job->issued_us;
+
+    replay_count[e->op]++;
+    replay_recorded_us[e->op] += e->duration_us;
+    replay_replayed_us[e->op] += took;
+    replay_worst_delay = MAX(replay_worst_delay, took - (gint64)e->duration_us);
+    g_free(job);
+
+    if (++replay_done == replay_header.n_entries) replay_finish_all();
+    return G_SOURCE_REMOVE;
+}
+
+static void replay_job_finish(gpointer data) {
+    g_idle_add(replay_job_done, data);
+}
+
+static gboolean replay_tick(gpointer data) {
+    gint64 base = replay_entries[0].time_us;
+    gint64 now = g_get_monotonic_time() - replay_start;
+
+    while (replay_next < replay_header.n_entries &&
+           replay_entries[replay_next].time_us - base <= now) {
+        const dmi_journal_entry *e = &replay_entries[replay_next++];
+        ReplayJob *job = g_new0(ReplayJob, 1);
+
+        job->entry = e;
+        job->issued_us = g_get_monotonic_time();
+        /* Key 0: every journaled operation is replayed, none is coalesced away */
+        dmi_sched_submit(dmi_display_list_get(replay_dlist, e->display), DMI_SCHED_INTERACTIVE,
+                         0, replay_job, job, replay_job_finish);
+    }
+
+    if (replay_next < replay_header.n_entries) {
+        gint64 wait = replay_entries[replay_next].time_us - base - now;
+        g_timeout_add((guint)((wait + 999) / 1000), replay_tick, NULL);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+void dmi_journal_replay_start(GApplication *app, dmi_display_list *dlist) {
+    if (!replay_displays || replay_app) return;
+
+    replay_app = app;
+    replay_dlist = dlist;
+
+    if (dlist->ct < replay_header.n_displays) {
+        g_printerr("replay: only %u of %u displays available\n", dlist->ct,
+                   replay_header.n_displays);
+        replay_status = 1;
+        g_application_quit(app);
+        return;
+    }
+
+    if (replay_header.n_entries == 0) {
+        replay_finish_all();
+        return;
+    }
+
+    replay_start = g_get_monotonic_time();
+    replay_tick(NULL);
+}
+
+int dmi_journal_replay_status(void) {
+    return replay_status;
+}
@@ -0,0 +1,73 @@
+#ifndef DMI_JOURNAL_H
+#define DMI_JOURNAL_H
+
+#include "dmi-api.h"
+
+/*
+ * DDC operation journal. With --journal=N the last N backend operations are kept in a
+ * ring buffer; SIGUSR2 writes them to $XDG_CACHE_HOME/dmi-gtk/journal-<time>.bin.
+ * --replay=FILE starts one simulated monitor per journaled display and issues the same
+ * operations through the scheduler at their original offsets. Each simulated operation
+ * takes as long as the recorded one and returns the same status. At the end, recorded and
+ * replayed latencies are compared.
+ *
+ * File layout, host-endian: a dmi_journal_header, n_displays dmi_journal_display entries,
+ * then n_entries dmi_journal_entry records, oldest first.
+ */
+
+#define DMI_JOURNAL_MAGIC 0x4a4d4444u /* "DDMJ" */
+#define DMI_JOURNAL_VERSION 1
+
+enum {
+    DMI_JOURNAL_GET = 1,
+    DMI_JOURNAL_SET = 2,
+    DMI_JOURNAL_CAPS = 3,
+};
+
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    guint32 n_displays;
+    guint32 n_entries;
+    /* g_get_real_time() when the journal was started */
+    gint64 started_us;
+} dmi_journal_header;
+
+typedef struct {
+    char id[DMI_DISPLAY_ID_LEN];
+    char model[16];
+    char mfg[4];
+    guint16 product;
+    guint16 reserved;
+} dmi_journal_display;
+
+typedef struct {
+    /* Start of the operation, microseconds since the journal was started */
+    gint64 time_us;
+    guint32 duration_us;
+    gint32 status;
+    guint16 value;
+    guint16 max;
+    guint16 display;
+    guint8 code;
+    guint8 op;
+} dmi_journal_entry;
+
+G_STATIC_ASSERT(sizeof(dmi_journal_entry) == 24);
+
+void dmi_journal_start(guint capacity);
+/* Records one backend operation that began at start_us (monotonic); any thread */
+void dmi_journal_record(dmi_display *disp, guint8 op, guint8 code, guint16 value, guint16 max,
+                        int status, gint64 start_us);
+/* Writes the ring to a new file and returns its path, NULL if journaling is off */
+char *dmi_journal_dump(GError **error);
+
+/* Reads a journal and returns the number of displays it covers, 0 on error */
+guint dmi_journal_replay_load(const char *path);
+/* Shapes the simulated displays after the journaled ones; call before the UI is built */
+void dmi_journal_replay_prepare(dmi_display_list *dlist);
+void dmi_journal_replay_start(GApplication *app, dmi_display_list *dlist);
+gboolean dmi_journal_replay_enabled(void);
+int dmi_journal_replay_status(void);
+
+#endif
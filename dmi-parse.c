@@ -0,0 +1,251 @@
+#include "dmi-parse.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PARSE_MAX_CODES 16
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-PARSE] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+static const char *skip_space(const char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+static gboolean is_token_end(char c) {
+    return c == '\0' || c == ' ' || c == '\t' || c == '\n' || c == ',' || c == ')';
+}
+
+gboolean dmi_parse_read_line(FILE *fp, char *line, gsize size) {
+    if (!fgets(line, size, fp)) return FALSE;
+
+    gsize len = strlen(line);
+    if (len == size - 1 && line[len - 1] != '\n') {
+        int c;
+        do {
+            c = getc(fp);
+        } while (c != EOF && c != '\n');
+
+        /* Drop the token that was cut in half */
+        char *space = strrchr(line, ' ');
+        if (space) *space = '\0';
+    }
+    return TRUE;
+}
+
+/* One number of at most 0xFFFF; hex needs the prefix unless base is 16 */
+static int parse_value(const char *p, int base) {
+    char *end;
+    p = skip_space(p);
+    if (base == 0) base = g_str_has_prefix(p, "0x") ? 16 : 10;
+
+    unsigned long v = strtoul(p, &end, base);
+    if (end == p || !is_token_end(*end) || v > 0xFFFF) return -1;
+    return (int)v;
+}
+
+/* --terse: "VCP 10 C 50 100", "VCP 60 SNC x0f", "VCP 60 CNC x00 x00 x00 x0f", "VCP 62 ERR" */
+static int parse_getvcp_terse(const char *p) {
+    char *end;
+    strtoul(p, &end, 16);
+    if (end == p) return -1;
+    p = skip_space(end);
+
+    if (g_str_has_prefix(p, "C ")) return parse_value(p + 2, 10);
+
+    if (g_str_has_prefix(p, "SNC ")) {
+        p = skip_space(p + 4);
+        return *p == 'x' ? parse_value(p + 1, 16) : -1;
+    }
+
+    if (g_str_has_prefix(p, "CNC ")) {
+        /* mh ml sh sl; the value is sh:sl */
+        int bytes[4];
+        p += 4;
+        for (int i = 0; i < 4; i++) {
+            p = skip_space(p);
+            if (*p != 'x') return -1;
+            bytes[i] = parse_value(p + 1, 16);
+            if (bytes[i] < 0 || bytes[i] > 0xFF) return -1;
+            p += 1 + strspn(p + 1, "0123456789abcdefABCDEF");
+        }
+        return bytes[2] << 8 | bytes[3];
+    }
+
+    return -1;
+}
+
+int dmi_parse_getvcp(const char *line) {
+    const char *p = skip_space(line);
+
+    if (g_str_has_prefix(p, "VCP ") && !g_str_has_prefix(p, "VCP code")) {
+        return parse_getvcp_terse(p + 4);
+    }
+
+    if ((p = strstr(line, "current value"))) {
+        p = strchr(p, '=');
+        return p ? parse_value(p + 1, 0) : -1;
+    }
+
+    /* Non-continuous features: "DisplayPort-1 (sl=0x0f)" or "(mh=0x00, ml=0x00, sh=0x00,
+     * sl=0x0f)" */
+    if ((p = strstr(line, "sl=0x"))) {
+        int sl = parse_value(p + 5, 16);
+        if (sl < 0 || sl > 0xFF) return -1;
+
+        const char *sh = strstr(line, "sh=0x");
+        int high = sh ? parse_value(sh + 5, 16) : 0;
+        return high >= 0 && high <= 0xFF ? high << 8 | sl : -1;
+    }
+
+    return -1;
+}
+
+guint dmi_parse_caps_inputs(dmi_parse_caps *state, const char *line, int *codes,
+                            guint max_codes) {
+    if (state->done) return 0;
+
+    const char *p = skip_space(line);
+    char *end;
+
+    if (g_str_has_prefix(p, "Feature:")) {
+        if (state->in_inputs) {
+            state->in_inputs = FALSE;
+            state->done = TRUE;
+            return 0;
+        }
+        p = skip_space(p + 8);
+        unsigned long code = strtoul(p, &end, 16);
+        state->in_inputs = end != p && is_token_end(*end) && code == 0x60;
+        return 0;
+    }
+
+    if (!state->in_inputs) return 0;
+
+    /* Values the tool cannot name come inline: "Values: 0f 11 12 (interpretation unavailable)" */
+    if (g_str_has_prefix(p, "Values:")) {
+        guint n = 0;
+        p += 7;
+        while (n < max_codes) {
+            p = skip_space(p);
+            unsigned long code = strtoul(p, &end, 16);
+            if (end == p || !is_token_end(*end) || code > 0xFF) break;
+            codes[n++] = (int)code;
+            p = end;
+        }
+        return n;
+    }
+
+    /* Otherwise one per line: "0f: DisplayPort-1" */
+    unsigned long code = strtoul(p, &end, 16);
+    if (end != p && *end == ':' && code <= 0xFF && max_codes > 0) {
+        codes[0] = (int)code;
+        return 1;
+    }
+    return 0;
+}
+
+void dmi_parse_detect_init(dmi_parse_detect *state) {
+    memset(state, 0, sizeof(*state));
+    state->bus = -1;
+}
+
+static gboolean detect_flush(dmi_parse_detect *state, dmi_parse_detect *out) {
+    gboolean complete = !state->skip && state->bus >= 0 && state->mfg[0] && state->model[0];
+
+    if (complete) *out = *state;
+    dmi_parse_detect_init(state);
+    return complete;
+}
+
+static void copy_value(char *dst, gsize size, const char *value) {
+    g_strlcpy(dst, skip_space(value), size);
+    g_strchomp(dst);
+}
+
+gboolean dmi_parse_detect_line(dmi_parse_detect *state, const char *line, dmi_parse_detect *out) {
+    if (!line) return detect_flush(state, out);
+
+    /* Blocks start in the first column; the Mfg id comes before the Model inside them, so a
+     * display is only complete once the next block or the end of input is reached */
+    if (g_str_has_prefix(line, "Display ")) return detect_flush(state, out);
+    /* Displays ddcutil cannot talk to, or that duplicate another, still list a bus and EDID */
+    if (g_str_has_prefix(line, "Invalid display") || g_str_has_prefix(line, "Phantom display")) {
+        gboolean found = detect_flush(state, out);
+        state->skip = TRUE;
+        return found;
+    }
+
+    const char *p;
+    if (strstr(line, "I2C bus:") && (p = strstr(line, "/dev/i2c-"))) {
+        char *end;
+        long bus = strtol(p + 9, &end, 10);
+        if (end != p + 9 && bus >= 0 && bus <= G_MAXUINT16) state->bus = (int)bus;
+    } else if ((p = strstr(line, "Mfg id:"))) {
+        /* "DEL - Dell Inc.": only the three-letter id matches the library's */
+        copy_value(state->mfg, sizeof(state->mfg), p + 7);
+        state->mfg[strcspn(state->mfg, " \t")] = '\0';
+    } else if ((p = strstr(line, "Model:"))) {
+        copy_value(state->model, sizeof(state->model), p + 6);
+    } else if ((p = strstr(line, "Serial number:"))) {
+        copy_value(state->sn, sizeof(state->sn), p + 14);
+    }
+
+    return FALSE;
+}
+
+int dmi_parse_main(const char *kind) {
+    gboolean detect = g_strcmp0(kind, "detect") == 0;
+    gboolean caps = g_strcmp0(kind, "caps") == 0;
+    gboolean getvcp = g_strcmp0(kind, "getvcp") == 0;
+
+    if (!detect && !caps && !getvcp) {
+        g_printerr("Unknown parser '%s', expected detect, caps or getvcp\n", kind);
+        return EXIT_FAILURE;
+    }
+
+    char line[DMI_PARSE_LINE_MAX];
+    dmi_parse_detect state, found;
+    dmi_parse_caps caps_state = {0};
+    int codes[PARSE_MAX_CODES];
+    guint64 bytes = 0, lines = 0, results = 0;
+    gint64 start = g_get_monotonic_time();
+
+    dmi_parse_detect_init(&state);
+
+    while (dmi_parse_read_line(stdin, line, sizeof(line))) {
+        bytes += strlen(line);
+        lines++;
+
+        if (detect && dmi_parse_detect_line(&state, line, &found)) {
+            printf("bus %d  mfg %s  model %s  sn %s\n", found.bus, found.mfg, found.model,
+                   found.sn);
+            results++;
+        } else if (caps) {
+            guint n = dmi_parse_caps_inputs(&caps_state, line, codes, PARSE_MAX_CODES);
+            for (guint i = 0; i < n; i++) printf("input 0x%02x\n", codes[i]);
+            results += n;
+        } else if (getvcp) {
+            int value = dmi_parse_getvcp(line);
+            if (value >= 0) {
+                printf("value %d\n", value);
+                results++;
+            }
+        }
+    }
+    if (detect && dmi_parse_detect_line(&state, NULL, &found)) {
+        printf("bus %d  mfg %s  model %s  sn %s\n", found.bus, found.mfg, found.model, found.sn);
+        results++;
+    }
+
+    double secs = MAX(g_get_monotonic_time() - start, 1) / (double)G_USEC_PER_SEC;
+    g_printerr("parse: %" G_GUINT64_FORMAT " lines, %" G_GUINT64_FORMAT " results, %.2f MiB in "
+               "%.1f ms (%.1f MiB/s)\n",
+               lines, results, bytes / 1048576.0, secs * 1000, bytes / 1048576.0 / secs);
+    return EXIT_SUCCESS;
+}
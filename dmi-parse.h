@@ -0,0 +1,52 @@
+#ifndef DMI_PARSE_H
+#define DMI_PARSE_H
+
+#include <glib.h>
+#include <stdio.h>
+
+/*
+ * Parsers for the text printed by `ddcutil detect`, `ddcutil capabilities` and
+ * `ddcutil getvcp`, used by the command line fallbacks. They take one line at a time and
+ * keep all state in fixed-size structs. Memory use does not depend on the input, however
+ * long a monitor's capabilities listing is. `dmi-gtk --parse=KIND` runs them on stdin.
+ */
+
+#define DMI_PARSE_LINE_MAX 512
+
+/* Like fgets, except the rest of an overlong line is skipped, so its tail is never parsed as
+ * a line of its own, and the line is cut back to its last complete word. FALSE at end of
+ * input. */
+gboolean dmi_parse_read_line(FILE *fp, char *line, gsize size);
+
+/* Current value of a `getvcp` line: "current value = 50", "(sl=0x0f)", or --terse
+ * "VCP 10 C 50 100" / "VCP 60 SNC x0f". -1 if the line carries none. */
+int dmi_parse_getvcp(const char *line);
+
+typedef struct {
+    gboolean in_inputs;
+    gboolean done;
+} dmi_parse_caps;
+
+/* Input source codes listed for feature 60 on one line of `capabilities` output. Stores at
+ * most max_codes of them in codes and returns how many were stored. */
+guint dmi_parse_caps_inputs(dmi_parse_caps *state, const char *line, int *codes,
+                            guint max_codes);
+
+typedef struct {
+    int bus;
+    char mfg[32];
+    char model[64];
+    char sn[64];
+    /* The block is an invalid or phantom display and is never emitted */
+    gboolean skip;
+} dmi_parse_detect;
+
+void dmi_parse_detect_init(dmi_parse_detect *state);
+/* Returns TRUE and fills out when a line ends a display block that named a bus, manufacturer
+ * and model. Pass NULL as the line at end of input to flush the last block. */
+gboolean dmi_parse_detect_line(dmi_parse_detect *state, const char *line, dmi_parse_detect *out);
+
+/* Parses stdin as detect, caps or getvcp output and prints the result and throughput */
+int dmi_parse_main(const char *kind);
+
+#endif
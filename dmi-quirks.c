@@ -0,0 +1,226 @@
+#include "dmi-quirks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QUIRK_MAX_SLOT_BITS 12
+#define QUIRK_SEED_TRIES 4096
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-QUIRKS] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+/*
+ * Only models whose behaviour has been seen first hand belong here; anything else goes in
+ * the user's quirks.ini. The second simulated model has no speaker.
+ */
+static const char builtin_quirks[] = "[quirk SIM 0x0002]\n"
+                                     "unsupported=0x62\n";
+
+static GArray *quirks = NULL;
+static gint *slots = NULL;
+static guint slot_bits = 0;
+static guint32 slot_seed = 0;
+static GOnce quirks_once = G_ONCE_INIT;
+
+/* Three 5-bit EDID letters and the product code fit one 32-bit key */
+static guint32 quirk_key(const char *mfg, guint16 product) {
+    guint32 key = 0;
+    for (int i = 0; i < 3 && mfg[i]; i++) key = (key << 5) | ((mfg[i] - '@') & 0x1f);
+    return (key << 16) | product;
+}
+
+static guint quirk_slot(guint32 key, guint32 seed, guint bits) {
+    return ((key ^ seed) * 0x9e3779b1u) >> (32 - bits);
+}
+
+static guint parse_code(const char *s, gboolean *ok) {
+    char *end;
+    unsigned long v = strtoul(s, &end, 0);
+    *ok = end != s && v <= 0xffff;
+    return (guint)v;
+}
+
+static void parse_quirk(GKeyFile *kf, const char *group, dmi_quirk *q) {
+    gchar **items = g_key_file_get_string_list(kf, group, "unsupported", NULL, NULL);
+    for (guint i = 0; items && items[i]; i++) {
+        gboolean ok;
+        guint code = parse_code(g_strstrip(items[i]), &ok);
+        if (ok && code <= 0xff) q->unsupported[code / 32] |= 1u << (code % 32);
+    }
+    g_strfreev(items);
+
+    if (g_key_file_has_key(kf, group, "capabilities", NULL)) {
+        q->no_capabilities = !g_key_file_get_boolean(kf, group, "capabilities", NULL);
+    }
+    if (g_key_file_has_key(kf, group, "spacing-ms", NULL)) {
+        q->spacing_ms = MAX(0, g_key_file_get_integer(kf, group, "spacing-ms", NULL));
+    }
+
+    items = g_key_file_get_string_list(kf, group, "max", NULL, NULL);
+    for (guint i = 0; items && items[i] && q->n_max < DMI_QUIRK_MAX_OVERRIDES; i++) {
+        char *sep = strchr(items[i], ':');
+        if (!sep) continue;
+        *sep = '\0';
+
+        gboolean ok_code, ok_max;
+        guint code = parse_code(g_strstrip(items[i]), &ok_code);
+        guint max = parse_code(g_strstrip(sep + 1), &ok_max);
+        if (!ok_code || !ok_max || code > 0xff || max == 0) continue;
+
+        q->max[q->n_max].code = code;
+        q->max[q->n_max].max = max;
+        q->n_max++;
+    }
+    g_strfreev(items);
+
+    items = g_key_file_get_string_list(kf, group, "input-remap", NULL, NULL);
+    for (guint i = 0; items && items[i] && q->n_remap < DMI_QUIRK_MAX_REMAPS; i++) {
+        char *sep = strchr(items[i], ':');
+        if (!sep) continue;
+        *sep = '\0';
+
+        gboolean ok_std, ok_mon;
+        guint standard = parse_code(g_strstrip(items[i]), &ok_std);
+        guint monitor = parse_code(g_strstrip(sep + 1), &ok_mon);
+        if (!ok_std || !ok_mon || standard > 0xff || monitor > 0xff) continue;
+
+        q->remap[q->n_remap].standard = standard;
+        q->remap[q->n_remap].monitor = monitor;
+        q->n_remap++;
+    }
+    g_strfreev(items);
+}
+
+/* Later sources replace earlier entries for the same model */
+static void load_quirks(GKeyFile *kf, GHashTable *by_key) {
+    gchar **groups = g_key_file_get_groups(kf, NULL);
+
+    for (guint i = 0; groups[i]; i++) {
+        char mfg[4] = {0};
+        unsigned int product;
+
+        if (sscanf(groups[i], "quirk %3s %x", mfg, &product) != 2 || product > 0xffff) {
+            g_printerr("Ignoring quirks group [%s]\n", groups[i]);
+            continue;
+        }
+
+        dmi_quirk *q = g_new0(dmi_quirk, 1);
+        memcpy(q->mfg, mfg, sizeof(q->mfg));
+        q->product = product;
+        parse_quirk(kf, groups[i], q);
+
+        g_hash_table_replace(by_key, GUINT_TO_POINTER(quirk_key(q->mfg, q->product)), q);
+    }
+    g_strfreev(groups);
+}
+
+/* Finds a seed that sends every key to its own slot, growing the table if none does */
+static gboolean build_index(void) {
+    guint n = quirks->len;
+
+    slot_bits = 1;
+    while ((1u << slot_bits) < n * 2) slot_bits++;
+
+    for (; slot_bits <= QUIRK_MAX_SLOT_BITS; slot_bits++) {
+        guint size = 1u << slot_bits;
+        slots = g_renew(gint, slots, size);
+
+        for (guint32 seed = 0; seed < QUIRK_SEED_TRIES; seed++) {
+            gboolean collision = FALSE;
+            memset(slots, 0xff, size * sizeof(gint));
+
+            for (guint i = 0; i < n && !collision; i++) {
+                dmi_quirk *q = &g_array_index(quirks, dmi_quirk, i);
+                guint s = quirk_slot(quirk_key(q->mfg, q->product), seed, slot_bits);
+                collision = slots[s] >= 0;
+                slots[s] = i;
+            }
+
+            if (!collision) {
+                slot_seed = seed;
+                DEBUG_PRINT("%u quirks in %u slots, seed %u\n", n, size, seed);
+                return TRUE;
+            }
+        }
+    }
+
+    g_clear_pointer(&slots, g_free);
+    return FALSE;
+}
+
+static gpointer quirks_init(gpointer data) {
+    GHashTable *by_key = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    GKeyFile *kf = g_key_file_new();
+
+    if (g_key_file_load_from_data(kf, builtin_quirks, -1, G_KEY_FILE_NONE, NULL)) {
+        load_quirks(kf, by_key);
+    }
+    g_key_file_free(kf);
+
+    char *path = g_build_filename(g_get_user_config_dir(), "dmi-gtk", "quirks.ini", NULL);
+    kf = g_key_file_new();
+    if (g_key_file_load_from_file(kf, path, G_KEY_FILE_NONE, NULL)) {
+        load_quirks(kf, by_key);
+    }
+    g_key_file_free(kf);
+    g_free(path);
+
+    quirks = g_array_sized_new(FALSE, FALSE, sizeof(dmi_quirk), g_hash_table_size(by_key));
+
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, by_key);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        g_array_append_vals(quirks, value, 1);
+    }
+    g_hash_table_destroy(by_key);
+
+    if (quirks->len > 0 && !build_index()) {
+        g_printerr("Failed to index %u quirks, ignoring them\n", quirks->len);
+    }
+    return NULL;
+}
+
+const dmi_quirk *dmi_quirks_lookup(const char *mfg, guint16 product) {
+    if (!mfg) return NULL;
+
+    g_once(&quirks_once, quirks_init, NULL);
+    if (!slots) return NULL;
+
+    guint32 key = quirk_key(mfg, product);
+    gint i = slots[quirk_slot(key, slot_seed, slot_bits)];
+    if (i < 0) return NULL;
+
+    const dmi_quirk *q = &g_array_index(quirks, dmi_quirk, i);
+    return quirk_key(q->mfg, q->product) == key ? q : NULL;
+}
+
+gboolean dmi_quirk_unsupported(const dmi_quirk *quirk, guint8 code) {
+    return quirk && (quirk->unsupported[code / 32] & (1u << (code % 32)));
+}
+
+guint16 dmi_quirk_max(const dmi_quirk *quirk, guint8 code, guint16 reported) {
+    for (guint i = 0; quirk && i < quirk->n_max; i++) {
+        if (quirk->max[i].code == code) return quirk->max[i].max;
+    }
+    return reported;
+}
+
+int dmi_quirk_input_to_monitor(const dmi_quirk *quirk, int code) {
+    for (guint i = 0; quirk && i < quirk->n_remap; i++) {
+        if (quirk->remap[i].standard == code) return quirk->remap[i].monitor;
+    }
+    return code;
+}
+
+int dmi_quirk_input_from_monitor(const dmi_quirk *quirk, int code) {
+    for (guint i = 0; quirk && i < quirk->n_remap; i++) {
+        if (quirk->remap[i].monitor == code) return quirk->remap[i].standard;
+    }
+    return code;
+}
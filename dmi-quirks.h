@@ -0,0 +1,50 @@
+#ifndef DMI_QUIRKS_H
+#define DMI_QUIRKS_H
+
+#include <glib.h>
+
+/*
+ * Per-model quirks, keyed by EDID manufacturer and product code. A built-in table is merged
+ * with $XDG_CONFIG_HOME/dmi-gtk/quirks.ini, whose entries replace built-in ones:
+ *
+ *   [quirk DEL 0xa0c4]
+ *   unsupported=0x62;0x16;0x18;0x1a   # never sent to the bus, fail at once
+ *   capabilities=false                # the capabilities string is missing or garbage
+ *   max=0x12:100;0x62:100             # maxima to use instead of the reported ones
+ *   spacing-ms=120                    # minimum gap between two commands to the monitor
+ *   input-remap=0x11:0x12             # standard input code : code the monitor uses
+ *
+ * The table is indexed by a perfect hash found at first lookup, so a lookup is one multiply
+ * and one compare.
+ */
+
+#define DMI_QUIRK_MAX_OVERRIDES 8
+#define DMI_QUIRK_MAX_REMAPS 4
+
+typedef struct _dmi_quirk {
+    char mfg[4];
+    guint16 product;
+    guint32 unsupported[8];
+    gboolean no_capabilities;
+    guint n_max;
+    struct {
+        guint8 code;
+        guint16 max;
+    } max[DMI_QUIRK_MAX_OVERRIDES];
+    guint spacing_ms;
+    guint n_remap;
+    struct {
+        guint8 standard;
+        guint8 monitor;
+    } remap[DMI_QUIRK_MAX_REMAPS];
+} dmi_quirk;
+
+/* NULL if the model has no quirks */
+const dmi_quirk *dmi_quirks_lookup(const char *mfg, guint16 product);
+
+gboolean dmi_quirk_unsupported(const dmi_quirk *quirk, guint8 code);
+guint16 dmi_quirk_max(const dmi_quirk *quirk, guint8 code, guint16 reported);
+int dmi_quirk_input_to_monitor(const dmi_quirk *quirk, int code);
+int dmi_quirk_input_from_monitor(const dmi_quirk *quirk, int code);
+
+#endif
@@ -0,0 +1,215 @@
+#include "dmi-sched.h"
+
+#include <stdio.h>
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-SCHED] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    dmi_display *disp;
+    guint key;
+    dmi_sched_func func;
+    gpointer data;
+    GDestroyNotify destroy;
+} SchedJob;
+
+typedef struct {
+    gint64 id;
+    GThread *thread;
+    GCond wakeup;
+    GQueue interactive;
+    GQueue background;
+    dmi_display *running;
+    gboolean quit;
+} BusQueue;
+
+static GMutex sched_lock;
+static GCond sched_idle;
+static GHashTable *bus_queues = NULL;
+
+static void sched_job_free(SchedJob *job) {
+    if (job->destroy) job->destroy(job->data);
+    g_free(job);
+}
+
+static gint64 bus_queue_id(dmi_display *disp) {
+    /* Displays without a known bus get a private queue keyed by address */
+    if (disp->i2c_busno >= 0) return disp->i2c_busno;
+    return -(gint64)(guintptr)disp;
+}
+
+static gpointer bus_queue_thread(gpointer data) {
+    BusQueue *q = data;
+
+    g_mutex_lock(&sched_lock);
+    while (!q->quit) {
+        SchedJob *job = g_queue_pop_head(&q->interactive);
+        if (!job) job = g_queue_pop_head(&q->background);
+        if (!job) {
+            g_cond_wait(&q->wakeup, &sched_lock);
+            continue;
+        }
+
+        q->running = job->disp;
+        g_mutex_unlock(&sched_lock);
+
+        job->func(job->disp, job->data);
+        sched_job_free(job);
+
+        g_mutex_lock(&sched_lock);
+        q->running = NULL;
+        g_cond_broadcast(&sched_idle);
+    }
+    g_mutex_unlock(&sched_lock);
+
+    return NULL;
+}
+
+static BusQueue *bus_queue_get(dmi_display *disp) {
+    gint64 id = bus_queue_id(disp);
+    BusQueue *q = g_hash_table_lookup(bus_queues, &id);
+    if (q) return q;
+
+    q = g_new0(BusQueue, 1);
+    q->id = id;
+    g_cond_init(&q->wakeup);
+    g_queue_init(&q->interactive);
+    g_queue_init(&q->background);
+    g_hash_table_insert(bus_queues, &q->id, q);
+
+    char name[16];
+    snprintf(name, sizeof(name), "dmi-bus-%" G_GINT64_FORMAT, id >= 0 ? id : -1);
+    q->thread = g_thread_new(name, bus_queue_thread, q);
+
+    DEBUG_PRINT("Started worker for bus %" G_GINT64_FORMAT "\n", id);
+    return q;
+}
+
+static gboolean bus_queue_coalesce(GQueue *queue, SchedJob *job) {
+    if (job->key == 0) return FALSE;
+
+    for (GList *l = queue->head; l != NULL; l = l->next) {
+        SchedJob *queued = l->data;
+        if (queued->disp == job->disp && queued->key == job->key) {
+            if (queued->destroy) queued->destroy(queued->data);
+            queued->func = job->func;
+            queued->data = job->data;
+            queued->destroy = job->destroy;
+            g_free(job);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void dmi_sched_init(void) {
+    g_mutex_lock(&sched_lock);
+    if (!bus_queues) {
+        bus_queues = g_hash_table_new(g_int64_hash, g_int64_equal);
+    }
+    g_mutex_unlock(&sched_lock);
+}
+
+void dmi_sched_submit(dmi_display *disp, dmi_sched_prio prio, guint key, dmi_sched_func func,
+                      gpointer data, GDestroyNotify destroy) {
+    if (!disp || !func) {
+        if (destroy) destroy(data);
+        return;
+    }
+
+    SchedJob *job = g_new0(SchedJob, 1);
+    job->disp = disp;
+    job->key = key;
+    job->func = func;
+    job->data = data;
+    job->destroy = destroy;
+
+    g_mutex_lock(&sched_lock);
+    if (!bus_queues) {
+        g_mutex_unlock(&sched_lock);
+        sched_job_free(job);
+        return;
+    }
+
+    BusQueue *q = bus_queue_get(disp);
+    GQueue *queue = (prio == DMI_SCHED_INTERACTIVE) ? &q->interactive : &q->background;
+
+    if (!bus_queue_coalesce(queue, job)) {
+        g_queue_push_tail(queue, job);
+        g_cond_signal(&q->wakeup);
+    }
+    g_mutex_unlock(&sched_lock);
+}
+
+static void bus_queue_drop(GQueue *queue, dmi_display *disp) {
+    GList *l = queue->head;
+    while (l != NULL) {
+        GList *next = l->next;
+        SchedJob *job = l->data;
+        if (job->disp == disp) {
+            g_queue_delete_link(queue, l);
+            sched_job_free(job);
+        }
+        l = next;
+    }
+}
+
+void dmi_sched_drop_display(dmi_display *disp) {
+    if (!disp) return;
+
+    g_mutex_lock(&sched_lock);
+    if (!bus_queues) {
+        g_mutex_unlock(&sched_lock);
+        return;
+    }
+
+    gint64 id = bus_queue_id(disp);
+    BusQueue *q = g_hash_table_lookup(bus_queues, &id);
+    if (q) {
+        bus_queue_drop(&q->background, disp);
+        bus_queue_drop(&q->interactive, disp);
+
+        while (q->running == disp) {
+            g_cond_wait(&sched_idle, &sched_lock);
+        }
+    }
+    g_mutex_unlock(&sched_lock);
+}
+
+void dmi_sched_shutdown(void) {
+    g_mutex_lock(&sched_lock);
+    if (!bus_queues) {
+        g_mutex_unlock(&sched_lock);
+        return;
+    }
+
+    GHashTable *queues = bus_queues;
+    bus_queues = NULL;
+
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, queues);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        BusQueue *q = value;
+        q->quit = TRUE;
+        g_cond_signal(&q->wakeup);
+    }
+    g_mutex_unlock(&sched_lock);
+
+    g_hash_table_iter_init(&iter, queues);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        BusQueue *q = value;
+        g_thread_join(q->thread);
+
+        g_queue_clear_full(&q->interactive, (GDestroyNotify)sched_job_free);
+        g_queue_clear_full(&q->background, (GDestroyNotify)sched_job_free);
+        g_cond_clear(&q->wakeup);
+        g_free(q);
+    }
+    g_hash_table_destroy(queues);
+}
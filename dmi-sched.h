@@ -0,0 +1,43 @@
+#ifndef DMI_SCHED_H
+#define DMI_SCHED_H
+
+#include "dmi-api.h"
+
+#include <glib.h>
+
+/*
+ * Per-bus DDC I/O scheduler. Every I2C bus gets its own worker thread and queue, so
+ * different buses run in parallel while traffic on one bus is strictly serialized.
+ * Interactive jobs (user writes) are always dequeued before background jobs (probes,
+ * capability fetches, refreshes). A running job is never interrupted, so a job that holds
+ * the bus for long, like a capabilities fetch, is best queued only when the user asks for
+ * its result.
+ */
+
+typedef enum {
+    DMI_SCHED_INTERACTIVE,
+    DMI_SCHED_BACKGROUND,
+} dmi_sched_prio;
+
+/* Runs on the bus worker thread. */
+typedef void (*dmi_sched_func)(dmi_display *disp, gpointer data);
+
+/* Coalescing key for writes of a single VCP feature: a newer queued job replaces the
+ * older one instead of queueing behind it. Key 0 never coalesces. */
+#define DMI_SCHED_KEY_VCP(code) (0x100u | (guint8)(code))
+/* All three gain channels share one key, so a drag ends in a single batched write */
+#define DMI_SCHED_KEY_RGB_GAIN 0x200u
+/* OSD change polling; a slow bus never piles up more than one poll per display */
+#define DMI_SCHED_KEY_SYNC 0x300u
+
+void dmi_sched_init(void);
+void dmi_sched_shutdown(void);
+
+void dmi_sched_submit(dmi_display *disp, dmi_sched_prio prio, guint key, dmi_sched_func func,
+                      gpointer data, GDestroyNotify destroy);
+
+/* Drops every queued job for disp and waits for a running one to finish. Called when the
+ * monitor is unplugged; must not be called from a bus worker. */
+void dmi_sched_drop_display(dmi_display *disp);
+
+#endif
@@ -0,0 +1,209 @@
+#include "dmi-sim.h"
+#include "dmi-backend.h"
+
+#include <ddcutil_status_codes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_FIRST_BUS 100
+#define SIM_PRODUCT 0x0001
+#define SIM_PRODUCT_NO_SPEAKER 0x0002
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-SIM] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    gint cur[256];
+    guint16 max[256];
+    gint reads[256];
+    gint writes[256];
+    gulong latency_us;
+    /* One-shot override of the next transaction, set by journal replay */
+    gboolean scripted;
+    gulong script_us;
+    int script_status;
+} SimMonitor;
+
+static const struct {
+    guint8 code;
+    guint16 cur;
+    guint16 max;
+} sim_features[] = {
+    {0x02, 0x01, 0x02}, /* new control value */
+    {0x52, 0x00, 0xff}, /* active control */
+    {0x10, 50, 100},    /* brightness */
+    {0x12, 75, 100},    /* contrast */
+    {0x14, 0x05, 0x0c}, /* colour preset */
+    {0x16, 50, 100},    /* red gain */
+    {0x18, 50, 100},    /* green gain */
+    {0x1a, 50, 100},    /* blue gain */
+    {0x62, 30, 100},    /* volume */
+    {0x60, 0x0f, 0x12}, /* input */
+};
+
+static const int sim_inputs[] = {0x0f, 0x11, 0x12};
+
+static int sim_transaction(SimMonitor *sim) {
+    if (!sim->scripted) {
+        g_usleep(sim->latency_us);
+        return 0;
+    }
+
+    sim->scripted = FALSE;
+    g_usleep(sim->script_us);
+    return sim->script_status;
+}
+
+static int sim_get_vcp(dmi_display *disp, guint8 code, guint16 *cur, guint16 *max) {
+    SimMonitor *sim = disp->backend_data;
+
+    int rc = sim_transaction(sim);
+    g_atomic_int_inc(&sim->reads[code]);
+
+    if (rc != 0) return rc;
+    if (sim->max[code] == 0) return DDCRC_REPORTED_UNSUPPORTED;
+
+    *cur = g_atomic_int_get(&sim->cur[code]);
+    *max = sim->max[code];
+    return 0;
+}
+
+static int sim_set_vcp(dmi_display *disp, guint8 code, guint16 value) {
+    SimMonitor *sim = disp->backend_data;
+
+    int rc = sim_transaction(sim);
+    if (rc != 0) return rc;
+    if (sim->max[code] == 0) return DDCRC_REPORTED_UNSUPPORTED;
+
+    g_atomic_int_set(&sim->cur[code], value);
+    g_atomic_int_inc(&sim->writes[code]);
+    DEBUG_PRINT("%s: VCP 0x%02x <- %u\n", disp->info.model_name, code, value);
+    return 0;
+}
+
+static int sim_get_inputs(dmi_display *disp, GArray *supported) {
+    SimMonitor *sim = disp->backend_data;
+
+    int rc = sim_transaction(sim);
+    if (rc != 0) return rc;
+    for (guint i = 0; i < G_N_ELEMENTS(sim_inputs); i++) {
+        dmi_inputs_add_code(disp, supported, sim_inputs[i]);
+    }
+    return 0;
+}
+
+/* A reopen costs the monitor one transaction and leaves its state alone */
+static int sim_reopen(dmi_display *disp) {
+    SimMonitor *sim = disp->backend_data;
+
+    g_usleep(sim->latency_us);
+    return 0;
+}
+
+static void sim_close(dmi_display *disp) {
+    g_free(disp->backend_data);
+    disp->backend_data = NULL;
+}
+
+static const dmi_backend sim_backend = {
+    .name = "sim",
+    .get_vcp = sim_get_vcp,
+    .set_vcp = sim_set_vcp,
+    .get_inputs = sim_get_inputs,
+    .close = sim_close,
+    .reopen = sim_reopen,
+};
+
+int dmi_sim_list_init(dmi_display_list *dlist, guint count, guint latency_ms) {
+    if (!dlist) return -1;
+
+    dlist->ct = 0;
+    dlist->list = NULL;
+    dlist->index = NULL;
+
+    for (guint i = 0; i < count; i++) {
+        SimMonitor *sim = g_new0(SimMonitor, 1);
+        sim->latency_us = (gulong)latency_ms * 1000;
+
+        for (guint f = 0; f < G_N_ELEMENTS(sim_features); f++) {
+            sim->cur[sim_features[f].code] = sim_features[f].cur;
+            sim->max[sim_features[f].code] = sim_features[f].max;
+        }
+        /* Every second model has no speaker, which the built-in quirks know about, and no
+         * OSD change register, so both ways of picking up OSD changes get exercised */
+        if (i % 2 == 1) {
+            sim->max[0x62] = 0;
+            sim->max[0x02] = 0;
+        }
+
+        dmi_display *disp = dmi_display_new(&sim_backend, sim);
+        disp->i2c_busno = SIM_FIRST_BUS + i;
+
+        snprintf(disp->info.mfg_id, sizeof(disp->info.mfg_id), "SIM");
+        disp->info.product_code = i % 2 == 1 ? SIM_PRODUCT_NO_SPEAKER : SIM_PRODUCT;
+        snprintf(disp->info.model_name, sizeof(disp->info.model_name), "Simulated %u", i + 1);
+        snprintf(disp->info.sn, sizeof(disp->info.sn), "%08u", i + 1);
+
+        /* Valid EDID header, then enough to make every simulated monitor unique */
+        static const guint8 header[] = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+        memcpy(disp->info.edid_bytes, header, sizeof(header));
+        disp->info.edid_bytes[12] = i & 0xff;
+        disp->info.edid_bytes[13] = (i >> 8) & 0xff;
+
+        /* Seed the cache the way a real probe would, without paying the latency */
+        dmi_display_cache_store(disp, 0x10, sim->cur[0x10], sim->max[0x10]);
+        dmi_display_cache_store(disp, 0x12, sim->cur[0x12], sim->max[0x12]);
+
+        dmi_display_list_append(dlist, disp);
+    }
+
+    dmi_display_list_finish(dlist);
+
+    g_print("Simulating %u displays (%u ms per transaction)\n", dlist->ct, latency_ms);
+    return 0;
+}
+
+gboolean dmi_display_is_simulated(dmi_display *disp) {
+    return disp && disp->backend == &sim_backend;
+}
+
+guint16 dmi_sim_get_value(dmi_display *disp, guint8 code) {
+    if (!dmi_display_is_simulated(disp)) return 0;
+    return g_atomic_int_get(&((SimMonitor *)disp->backend_data)->cur[code]);
+}
+
+guint dmi_sim_get_writes(dmi_display *disp, guint8 code) {
+    if (!dmi_display_is_simulated(disp)) return 0;
+    return g_atomic_int_get(&((SimMonitor *)disp->backend_data)->writes[code]);
+}
+
+guint dmi_sim_get_reads(dmi_display *disp, guint8 code) {
+    if (!dmi_display_is_simulated(disp)) return 0;
+    return g_atomic_int_get(&((SimMonitor *)disp->backend_data)->reads[code]);
+}
+
+void dmi_sim_set_feature(dmi_display *disp, guint8 code, guint16 cur, guint16 max) {
+    if (!dmi_display_is_simulated(disp)) return;
+
+    SimMonitor *sim = disp->backend_data;
+    g_atomic_int_set(&sim->cur[code], cur);
+    sim->max[code] = max;
+}
+
+void dmi_sim_script_next(dmi_display *disp, guint32 duration_us, int status) {
+    if (!dmi_display_is_simulated(disp)) return;
+
+    SimMonitor *sim = disp->backend_data;
+    sim->script_us = duration_us;
+    sim->script_status = status;
+    sim->scripted = TRUE;
+}
+
+void dmi_sim_script_clear(dmi_display *disp) {
+    if (!dmi_display_is_simulated(disp)) return;
+    ((SimMonitor *)disp->backend_data)->scripted = FALSE;
+}
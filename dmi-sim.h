@@ -0,0 +1,26 @@
+#ifndef DMI_SIM_H
+#define DMI_SIM_H
+
+#include "dmi-api.h"
+
+/*
+ * Simulated monitors for exercising the UI and scheduler without hardware. Every read and
+ * write sleeps for latency_ms, roughly what a DDC/CI transaction costs on a real bus.
+ */
+
+int dmi_sim_list_init(dmi_display_list *dlist, guint count, guint latency_ms);
+
+gboolean dmi_display_is_simulated(dmi_display *disp);
+
+/* Current value of a feature and how many reads/writes reached the "monitor" */
+guint16 dmi_sim_get_value(dmi_display *disp, guint8 code);
+guint dmi_sim_get_writes(dmi_display *disp, guint8 code);
+guint dmi_sim_get_reads(dmi_display *disp, guint8 code);
+
+/* Journal replay: gives a feature a value and maximum, adding it if the model lacks it */
+void dmi_sim_set_feature(dmi_display *disp, guint8 code, guint16 cur, guint16 max);
+/* Journal replay: the next transaction on disp takes duration_us and returns status */
+void dmi_sim_script_next(dmi_display *disp, guint32 duration_us, int status);
+void dmi_sim_script_clear(dmi_display *disp);
+
+#endif
@@ -0,0 +1,304 @@
+#include "dmi-soak.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define SOAK_DRIVE_MS 100
+#define SOAK_ACTIVE_SEC 20
+#define SOAK_SHOW_SEC 26
+#define SOAK_DROPDOWN_EVERY 20
+#define SOAK_WARMUP_CYCLES 2
+#define SOAK_SEED 0x50a4
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-SOAK] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef enum {
+    SOAK_ACTIVE,
+    SOAK_HIDDEN,
+    SOAK_SHOWN,
+} SoakPhase;
+
+enum {
+    METRIC_RSS,
+    METRIC_FDS,
+    METRIC_OBJECTS,
+    METRIC_HEAP,
+    METRIC_COUNT,
+};
+
+static const struct {
+    const char *name;
+    const char *unit;
+    /* Growth up to this much is noise: allocator slack, caches warming up */
+    double floor;
+} soak_metrics[METRIC_COUNT] = {
+    [METRIC_RSS] = {"rss", "KiB", 1024},
+    [METRIC_FDS] = {"fds", "", 0},
+    [METRIC_OBJECTS] = {"gobjects", "", 32},
+    [METRIC_HEAP] = {"heap", "KiB", 512},
+};
+
+typedef struct {
+    double v[METRIC_COUNT];
+} SoakSample;
+
+static guint soak_cycles = 0;
+static gboolean soak_enabled = FALSE;
+static GApplication *soak_app = NULL;
+static dmi_display_list *soak_dlist = NULL;
+static GArray *samples = NULL;
+static GRand *rng = NULL;
+
+static guint drive_id = 0;
+static guint cycle = 0;
+static guint ticks = 0;
+static guint changes = 0;
+static guint switches = 0;
+static SoakPhase phase = SOAK_ACTIVE;
+static gint64 cycle_start = 0;
+static int status = 0;
+
+void dmi_soak_reexec(int argc, char **argv) {
+    gboolean soak = FALSE;
+    for (int i = 1; i < argc; i++) {
+        if (g_str_has_prefix(argv[i], "--soak")) soak = TRUE;
+    }
+    if (!soak || g_getenv("GOBJECT_DEBUG")) return;
+
+    g_setenv("GOBJECT_DEBUG", "instance-count", TRUE);
+    execv("/proc/self/exe", argv);
+    g_printerr("soak: could not re-execute, GObject counts will read 0\n");
+}
+
+void dmi_soak_init(guint minutes) {
+    if (soak_enabled) return;
+
+    soak_enabled = TRUE;
+    soak_cycles = minutes * 60 / DMI_SOAK_CYCLE_SEC;
+    samples = g_array_new(FALSE, FALSE, sizeof(SoakSample));
+    rng = g_rand_new_with_seed(SOAK_SEED);
+}
+
+gboolean dmi_soak_enabled(void) {
+    return soak_enabled;
+}
+
+int dmi_soak_status(void) {
+    return status;
+}
+
+static double sample_rss_kib(void) {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) return 0;
+
+    long size, resident;
+    int n = fscanf(fp, "%ld %ld", &size, &resident);
+    fclose(fp);
+
+    return n == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024.0) : 0;
+}
+
+static double sample_fds(void) {
+    GDir *dir = g_dir_open("/proc/self/fd", 0, NULL);
+    if (!dir) return 0;
+
+    /* The directory's own descriptor is in the count every time, so it cancels out */
+    guint n = 0;
+    while (g_dir_read_name(dir)) n++;
+    g_dir_close(dir);
+    return n;
+}
+
+/* Zero for every type unless GOBJECT_DEBUG=instance-count was set at startup */
+static guint count_instances(GType type) {
+    guint n_children;
+    GType *children = g_type_children(type, &n_children);
+    guint count = g_type_get_instance_count(type);
+
+    for (guint i = 0; i < n_children; i++) {
+        count += count_instances(children[i]);
+    }
+    g_free(children);
+    return count;
+}
+
+static double sample_heap_kib(void) {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks / 1024.0;
+#endif
+#endif
+    return 0;
+}
+
+static void soak_sample(void) {
+    SoakSample s;
+
+    s.v[METRIC_RSS] = sample_rss_kib();
+    s.v[METRIC_FDS] = sample_fds();
+    s.v[METRIC_OBJECTS] = count_instances(G_TYPE_OBJECT);
+    s.v[METRIC_HEAP] = sample_heap_kib();
+    g_array_append_val(samples, s);
+
+    g_print("soak: cycle %u/%u: rss %.0f KiB, %.0f fds, %.0f gobjects, heap %.0f KiB\n",
+            cycle + 1, soak_cycles, s.v[METRIC_RSS], s.v[METRIC_FDS], s.v[METRIC_OBJECTS],
+            s.v[METRIC_HEAP]);
+}
+
+/* Growth has to hold for the whole run: every late sample above every early one */
+static void soak_report(void) {
+    guint first = MIN(SOAK_WARMUP_CYCLES, samples->len);
+    guint third = (samples->len - first) / 3;
+
+    g_print("soak: %u cycles, %u slider changes, %u dropdown switches\n", cycle, changes,
+            switches);
+
+    if (third == 0) {
+        g_print("soak: FAIL: too few samples to judge growth\n");
+        status = 1;
+        return;
+    }
+
+    for (guint m = 0; m < METRIC_COUNT; m++) {
+        double early_max = 0, late_min = G_MAXDOUBLE;
+
+        for (guint i = first; i < first + third; i++) {
+            early_max = MAX(early_max, g_array_index(samples, SoakSample, i).v[m]);
+        }
+        for (guint i = samples->len - third; i < samples->len; i++) {
+            late_min = MIN(late_min, g_array_index(samples, SoakSample, i).v[m]);
+        }
+
+        gboolean grew = late_min > early_max + soak_metrics[m].floor;
+        g_print("soak: %-8s early max %10.0f %-3s late min %10.0f %-3s %s\n", soak_metrics[m].name,
+                early_max, soak_metrics[m].unit, late_min, soak_metrics[m].unit,
+                grew ? "GROWING" : "ok");
+        if (grew) {
+            g_print("soak: FAIL: %s grew by %.0f %s\n", soak_metrics[m].name, late_min - early_max,
+                    soak_metrics[m].unit);
+            status = 1;
+        }
+    }
+}
+
+static GtkWidget *soak_window(void) {
+    GList *windows = gtk_application_get_windows(GTK_APPLICATION(soak_app));
+    return windows ? windows->data : NULL;
+}
+
+/* The UI is rebuilt every cycle, so the controls are looked up again each time */
+static void collect_controls(GtkWidget *widget, GPtrArray *scales, GPtrArray *dropdowns) {
+    for (GtkWidget *child = gtk_widget_get_first_child(widget); child;
+         child = gtk_widget_get_next_sibling(child)) {
+        if (GTK_IS_SCALE(child)) {
+            if (gtk_widget_is_sensitive(child)) g_ptr_array_add(scales, child);
+        } else if (GTK_IS_DROP_DOWN(child)) {
+            if (gtk_widget_is_sensitive(child)) g_ptr_array_add(dropdowns, child);
+        } else {
+            collect_controls(child, scales, dropdowns);
+        }
+    }
+}
+
+static void soak_drive(GtkWidget *window) {
+    GPtrArray *scales = g_ptr_array_new();
+    GPtrArray *dropdowns = g_ptr_array_new();
+    collect_controls(window, scales, dropdowns);
+
+    if (scales->len > 0) {
+        GtkRange *range = g_ptr_array_index(scales, g_rand_int_range(rng, 0, scales->len));
+        GtkAdjustment *adj = gtk_range_get_adjustment(range);
+        int lower = (int)gtk_adjustment_get_lower(adj);
+        int upper = (int)gtk_adjustment_get_upper(adj);
+
+        gtk_range_set_value(range, g_rand_int_range(rng, lower, upper + 1));
+        changes++;
+    }
+
+    if (dropdowns->len > 0 && ticks % SOAK_DROPDOWN_EVERY == 0) {
+        GtkDropDown *dropdown =
+            g_ptr_array_index(dropdowns, g_rand_int_range(rng, 0, dropdowns->len));
+        guint n = g_list_model_get_n_items(gtk_drop_down_get_model(dropdown));
+
+        if (n > 1) {
+            guint next = (gtk_drop_down_get_selected(dropdown) + g_rand_int_range(rng, 1, n)) % n;
+            gtk_drop_down_set_selected(dropdown, next);
+            switches++;
+        }
+    }
+
+    g_ptr_array_free(scales, TRUE);
+    g_ptr_array_free(dropdowns, TRUE);
+}
+
+/* What the hotplug handler does when a monitor comes back, so the next call on each display
+ * goes through the reopen path */
+static void soak_hotplug(void) {
+    for (guint i = 0; soak_dlist && i < soak_dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(soak_dlist, i);
+        dmi_display_reset_health(disp);
+        g_atomic_int_set(&disp->handle_stale, TRUE);
+    }
+}
+
+static gboolean soak_tick(gpointer data) {
+    gint64 elapsed = g_get_monotonic_time() - cycle_start;
+    GtkWidget *window = soak_window();
+
+    ticks++;
+
+    switch (phase) {
+    case SOAK_ACTIVE:
+        if (elapsed < SOAK_ACTIVE_SEC * G_USEC_PER_SEC) {
+            if (window && gtk_widget_get_visible(window)) soak_drive(window);
+            break;
+        }
+        DEBUG_PRINT("Cycle %u: hiding\n", cycle + 1);
+        if (window) gtk_widget_set_visible(window, FALSE);
+        soak_hotplug();
+        phase = SOAK_HIDDEN;
+        break;
+    case SOAK_HIDDEN:
+        if (elapsed < SOAK_SHOW_SEC * G_USEC_PER_SEC) break;
+        DEBUG_PRINT("Cycle %u: showing\n", cycle + 1);
+        /* Rebuilds the released UI, or just shows the window if it is still around */
+        g_application_activate(soak_app);
+        phase = SOAK_SHOWN;
+        break;
+    case SOAK_SHOWN:
+        if (elapsed < DMI_SOAK_CYCLE_SEC * G_USEC_PER_SEC) break;
+        soak_sample();
+        if (++cycle >= soak_cycles) {
+            soak_report();
+            drive_id = 0;
+            g_application_quit(soak_app);
+            return G_SOURCE_REMOVE;
+        }
+        phase = SOAK_ACTIVE;
+        cycle_start = g_get_monotonic_time();
+        break;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+void dmi_soak_start(GApplication *app, dmi_display_list *dlist) {
+    if (!soak_enabled || drive_id > 0 || cycle > 0) return;
+
+    soak_app = app;
+    soak_dlist = dlist;
+
+    g_print("soak: %u cycles of %d s against %u displays\n", soak_cycles, DMI_SOAK_CYCLE_SEC,
+            dlist ? dlist->ct : 0);
+
+    cycle_start = g_get_monotonic_time();
+    drive_id = g_timeout_add(SOAK_DRIVE_MS, soak_tick, NULL);
+}
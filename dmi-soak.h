@@ -0,0 +1,34 @@
+#ifndef DMI_SOAK_H
+#define DMI_SOAK_H
+
+#include "dmi-api.h"
+
+#include <gtk/gtk.h>
+
+/*
+ * Long-running leak check against simulated displays. Each DMI_SOAK_CYCLE_SEC cycle drags
+ * random sliders, switches inputs and colour presets, then hides the window long enough for
+ * the UI to be released, replays a hotplug on every display and shows the window again. After
+ * each cycle the resident size, open file descriptors, live GObjects and the malloc heap in
+ * use are sampled. A metric fails the run when every sample in the last third of the run is
+ * above every sample in the first third by more than its noise floor.
+ */
+
+#define DMI_SOAK_CYCLE_SEC 30
+/* Replaces the configured release delay so every hide also frees and rebuilds the UI */
+#define DMI_SOAK_RELEASE_SEC 2
+#define DMI_SOAK_MIN_MINUTES 3
+
+/* Live GObject counts need GOBJECT_DEBUG=instance-count before GObject initializes, so a soak
+ * run re-executes itself once with it set. Call first thing in main(). */
+void dmi_soak_reexec(int argc, char **argv);
+
+void dmi_soak_init(guint minutes);
+gboolean dmi_soak_enabled(void);
+
+/* Starts the cycles once the first UI is complete; later calls are ignored */
+void dmi_soak_start(GApplication *app, dmi_display_list *dlist);
+
+int dmi_soak_status(void);
+
+#endif
@@ -0,0 +1,143 @@
+#include "dmi-state.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-STATE] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+static GMutex state_lock;
+static dmi_state_header *state = NULL;
+static gsize state_size = 0;
+static char *state_path = NULL;
+/* dmi_display * -> record index + 1 */
+static GHashTable *record_index = NULL;
+
+static dmi_state_record *state_record(guint index) {
+    return (dmi_state_record *)((char *)state + state->header_size) + index;
+}
+
+static void record_fill(dmi_state_record *rec, dmi_display *disp) {
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+
+    g_strlcpy(rec->id, disp->id, sizeof(rec->id));
+    g_strlcpy(rec->model, disp->info.model_name, sizeof(rec->model));
+    rec->i2c_busno = disp->i2c_busno;
+    rec->input = v.input_val;
+    rec->brightness = v.brightness_val;
+    rec->brightness_max = v.brightness_max;
+    rec->contrast = v.contrast_val;
+    rec->contrast_max = v.contrast_max;
+    rec->ctemp = v.ctemp_val;
+    rec->ctemp_max = v.ctemp_max;
+    rec->volume = v.volume_val;
+    rec->volume_max = v.volume_max;
+    rec->red_gain = v.red_gain_val;
+    rec->red_gain_max = v.red_gain_max;
+    rec->green_gain = v.green_gain_val;
+    rec->green_gain_max = v.green_gain_max;
+    rec->blue_gain = v.blue_gain_val;
+    rec->blue_gain_max = v.blue_gain_max;
+    rec->updated_us = g_get_real_time();
+}
+
+static void state_display_changed(dmi_display *disp, guint8 code, gpointer user_data) {
+    g_mutex_lock(&state_lock);
+
+    guint index = state ? GPOINTER_TO_UINT(g_hash_table_lookup(record_index, disp)) : 0;
+    if (index == 0) {
+        g_mutex_unlock(&state_lock);
+        return;
+    }
+
+    guint32 seq = state->seq;
+    __atomic_store_n(&state->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record_fill(state_record(index - 1), disp);
+    state->updated_us = g_get_real_time();
+
+    __atomic_store_n(&state->seq, seq + 2, __ATOMIC_RELEASE);
+    g_mutex_unlock(&state_lock);
+
+    DEBUG_PRINT("%s: VCP 0x%02x published\n", disp->id, code);
+}
+
+gboolean dmi_state_init(dmi_display_list *dlist) {
+    if (state || !dlist) return FALSE;
+
+    state_path = g_build_filename(g_get_user_runtime_dir(), DMI_STATE_FILE, NULL);
+    char *tmp_path = g_strconcat(state_path, ".tmp", NULL);
+    state_size = sizeof(dmi_state_header) + dlist->ct * sizeof(dmi_state_record);
+
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, state_size) != 0) {
+        g_printerr("Failed to create %s: %s\n", tmp_path, g_strerror(errno));
+        if (fd >= 0) close(fd);
+        g_free(tmp_path);
+        g_clear_pointer(&state_path, g_free);
+        return FALSE;
+    }
+
+    void *map = mmap(NULL, state_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        g_printerr("Failed to map %s: %s\n", tmp_path, g_strerror(errno));
+        unlink(tmp_path);
+        g_free(tmp_path);
+        g_clear_pointer(&state_path, g_free);
+        return FALSE;
+    }
+
+    dmi_state_header *hdr = map;
+    hdr->magic = DMI_STATE_MAGIC;
+    hdr->version = DMI_STATE_VERSION;
+    hdr->header_size = sizeof(dmi_state_header);
+    hdr->record_size = sizeof(dmi_state_record);
+    hdr->n_records = dlist->ct;
+    hdr->updated_us = g_get_real_time();
+
+    g_mutex_lock(&state_lock);
+    state = hdr;
+    record_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (guint i = 0; i < dlist->ct; i++) {
+        dmi_display *disp = dmi_display_list_get(dlist, i);
+        record_fill(state_record(i), disp);
+        g_hash_table_insert(record_index, disp, GUINT_TO_POINTER(i + 1));
+    }
+    g_mutex_unlock(&state_lock);
+
+    /* Readers only ever see a fully initialized file under the final name */
+    if (rename(tmp_path, state_path) != 0) {
+        g_printerr("Failed to publish %s: %s\n", state_path, g_strerror(errno));
+    }
+    g_free(tmp_path);
+
+    dmi_set_value_observer(state_display_changed, NULL);
+    DEBUG_PRINT("Publishing %u displays to %s\n", dlist->ct, state_path);
+    return TRUE;
+}
+
+void dmi_state_shutdown(void) {
+    dmi_set_value_observer(NULL, NULL);
+
+    g_mutex_lock(&state_lock);
+    if (state) {
+        munmap(state, state_size);
+        state = NULL;
+        unlink(state_path);
+    }
+    g_clear_pointer(&record_index, g_hash_table_destroy);
+    g_clear_pointer(&state_path, g_free);
+    g_mutex_unlock(&state_lock);
+}
@@ -0,0 +1,80 @@
+#ifndef DMI_STATE_H
+#define DMI_STATE_H
+
+#include "dmi-api.h"
+
+/*
+ * Shared state file for status bars and scripts: $XDG_RUNTIME_DIR/dmi-gtk.state holds a
+ * header followed by one fixed-size record per display and is rewritten in place whenever
+ * a cached value changes. Readers mmap it read-only and never touch the bus.
+ *
+ * Consistency is a seqlock on the header: seq is odd while a record is being written.
+ * Read seq, copy the record, read seq again, and retry if seq was odd or changed.
+ * dmi_state_read_record() below does exactly that. All fields are host-endian.
+ */
+
+#define DMI_STATE_MAGIC 0x534d4444u /* "DDMS" */
+#define DMI_STATE_VERSION 1
+#define DMI_STATE_FILE "dmi-gtk.state"
+
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    guint32 header_size;
+    guint32 record_size;
+    guint32 n_records;
+    guint32 seq;
+    gint64 updated_us;
+} dmi_state_header;
+
+typedef struct {
+    char id[DMI_DISPLAY_ID_LEN];
+    char model[16];
+    gint32 i2c_busno;
+    /* VCP 0x60 value, -1 when unknown */
+    gint32 input;
+    guint16 brightness;
+    guint16 brightness_max;
+    guint16 contrast;
+    guint16 contrast_max;
+    guint16 ctemp;
+    guint16 ctemp_max;
+    guint16 volume;
+    guint16 volume_max;
+    guint16 red_gain;
+    guint16 red_gain_max;
+    guint16 green_gain;
+    guint16 green_gain_max;
+    guint16 blue_gain;
+    guint16 blue_gain_max;
+    /* g_get_real_time() of the last change to this record */
+    gint64 updated_us;
+} dmi_state_record;
+
+gboolean dmi_state_init(dmi_display_list *dlist);
+void dmi_state_shutdown(void);
+
+static inline gboolean dmi_state_read_record(const dmi_state_header *hdr, guint32 index,
+                                             dmi_state_record *out) {
+    if (hdr->magic != DMI_STATE_MAGIC || hdr->version != DMI_STATE_VERSION ||
+        index >= hdr->n_records) {
+        return FALSE;
+    }
+
+    const dmi_state_record *rec =
+        (const dmi_state_record *)((const char *)hdr + hdr->header_size) + index;
+
+    /* Bounded, so a writer that died mid-update cannot hang the reader */
+    for (int tries = 0; tries < 1000; tries++) {
+        guint32 before = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+
+        *out = *rec;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == before) return TRUE;
+    }
+    return FALSE;
+}
+
+#endif
@@ -0,0 +1,311 @@
+#include "dmi-stress.h"
+#include "dmi-sim.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/resource.h>
+
+#define STRESS_MAX_GAP_MS 50
+#define STRESS_MAX_FRAME_P99_MS 50
+#define STRESS_SETTLE_MS 2000
+#define STRESS_SETTLE_POLL_MS 20
+#define STRESS_SEED 0x5eed
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-STRESS] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    GtkWidget *scale;
+    dmi_display *disp;
+    guint8 code;
+    guint requested;
+    guint writes_before;
+    int last;
+} StressTarget;
+
+static guint stress_seconds = 0;
+static GPtrArray *targets = NULL;
+static GPtrArray *dropdowns = NULL;
+static GApplication *stress_app = NULL;
+static GtkWidget *stress_window = NULL;
+static GRand *rng = NULL;
+
+static guint drive_id = 0;
+static guint tick_cb_id = 0;
+static guint ticks = 0;
+static guint switches = 0;
+static gint64 init_time = 0;
+static gint64 first_frame = 0;
+static gint64 start_time = 0;
+static gint64 cpu_start = 0;
+static gint64 cpu_used = 0;
+static gint64 drive_elapsed = 0;
+static gint64 last_dispatch = 0;
+static gint64 max_gap = 0;
+static gint64 last_frame = 0;
+static GArray *frame_intervals = NULL;
+static gint64 settle_start = 0;
+static int status = 0;
+
+static void stress_target_free(gpointer data) {
+    StressTarget *t = data;
+
+    g_object_unref(t->scale);
+    g_free(t);
+}
+
+void dmi_stress_init(guint seconds) {
+    if (targets) return;
+
+    stress_seconds = seconds;
+    init_time = g_get_monotonic_time();
+    targets = g_ptr_array_new_with_free_func(stress_target_free);
+    dropdowns = g_ptr_array_new_with_free_func(g_object_unref);
+    frame_intervals = g_array_new(FALSE, FALSE, sizeof(gint64));
+    rng = g_rand_new_with_seed(STRESS_SEED);
+}
+
+gboolean dmi_stress_enabled(void) {
+    return targets != NULL;
+}
+
+void dmi_stress_register(GtkWidget *scale, dmi_display *disp, guint8 code) {
+    if (!targets || !scale || !disp) return;
+
+    StressTarget *t = g_new0(StressTarget, 1);
+    t->scale = g_object_ref(scale);
+    t->disp = disp;
+    t->code = code;
+    t->last = -1;
+    g_ptr_array_add(targets, t);
+}
+
+void dmi_stress_register_dropdown(GtkWidget *dropdown) {
+    if (!dropdowns || !dropdown) return;
+
+    g_ptr_array_add(dropdowns, g_object_ref(dropdown));
+}
+
+static gint64 cpu_time_us(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (gint64)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * G_USEC_PER_SEC +
+           ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static gint compare_gint64(gconstpointer a, gconstpointer b) {
+    gint64 x = *(const gint64 *)a;
+    gint64 y = *(const gint64 *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(GArray *sorted, double pct) {
+    if (sorted->len == 0) return 0;
+
+    guint i = (guint)(pct / 100.0 * (sorted->len - 1) + 0.5);
+    return g_array_index(sorted, gint64, i) / 1000.0;
+}
+
+static void stress_fail(const char *fmt, ...) G_GNUC_PRINTF(1, 2);
+
+static void stress_fail(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    char *msg = g_strdup_vprintf(fmt, args);
+    va_end(args);
+
+    g_print("stress: FAIL: %s\n", msg);
+    g_free(msg);
+    status = 1;
+}
+
+static void stress_report(gboolean settled) {
+    double secs = drive_elapsed / (double)G_USEC_PER_SEC;
+
+    g_print("stress: %u scales, %.1f s at %.1f Hz\n", targets->len, secs,
+            secs > 0 ? ticks / secs : 0);
+
+    guint changes = 0;
+    for (guint i = 0; i < targets->len; i++) {
+        changes += ((StressTarget *)g_ptr_array_index(targets, i))->requested;
+    }
+
+    g_print("stress: first frame %.1f ms after startup\n", (first_frame - init_time) / 1000.0);
+    g_print("stress: %.1f us CPU per event (%u changes, %u input switches)\n",
+            changes + switches ? (double)cpu_used / (changes + switches) : 0, changes, switches);
+
+    g_print("stress: dispatch gap max %.1f ms (limit %d)\n", max_gap / 1000.0,
+            STRESS_MAX_GAP_MS);
+    if (max_gap > STRESS_MAX_GAP_MS * 1000) {
+        stress_fail("main loop stalled for %.1f ms", max_gap / 1000.0);
+    }
+
+    GArray *sorted = g_array_copy(frame_intervals);
+    g_array_sort(sorted, compare_gint64);
+    double p99 = percentile_ms(sorted, 99);
+
+    g_print("stress: %u frames, interval p50 %.1f ms, p99 %.1f ms, max %.1f ms (p99 limit %d)\n",
+            sorted->len, percentile_ms(sorted, 50), p99, percentile_ms(sorted, 100),
+            STRESS_MAX_FRAME_P99_MS);
+    if (sorted->len == 0) {
+        stress_fail("no frames were drawn; is the window visible?");
+    } else if (p99 > STRESS_MAX_FRAME_P99_MS) {
+        stress_fail("p99 frame interval %.1f ms", p99);
+    }
+    g_array_free(sorted, TRUE);
+
+    for (guint i = 0; i < targets->len; i++) {
+        StressTarget *t = g_ptr_array_index(targets, i);
+        guint writes = dmi_sim_get_writes(t->disp, t->code) - t->writes_before;
+        guint16 final = dmi_sim_get_value(t->disp, t->code);
+        gboolean ok = t->last < 0 || final == t->last;
+
+        g_print("stress: %s VCP 0x%02x: %u changes, %u writes (%.1f%%), final %u %s\n",
+                t->disp->info.model_name, t->code, t->requested, writes,
+                t->requested ? 100.0 * writes / t->requested : 0, final,
+                ok ? "ok" : "MISMATCH");
+
+        if (!ok) {
+            stress_fail("%s VCP 0x%02x ended at %u, last requested %d", t->disp->info.model_name,
+                        t->code, final, t->last);
+        }
+        if (writes > t->requested) {
+            stress_fail("%s VCP 0x%02x issued more writes than changes", t->disp->info.model_name,
+                        t->code);
+        }
+    }
+
+    if (settled) {
+        g_print("stress: settled in %" G_GINT64_FORMAT " ms (limit %d)\n",
+                (g_get_monotonic_time() - settle_start) / 1000, STRESS_SETTLE_MS);
+    } else {
+        stress_fail("displays did not settle within %d ms", STRESS_SETTLE_MS);
+    }
+
+    g_print("stress: %s\n", status == 0 ? "PASS" : "FAIL");
+}
+
+static gboolean stress_settle(gpointer data) {
+    gboolean settled = TRUE;
+
+    for (guint i = 0; i < targets->len && settled; i++) {
+        StressTarget *t = g_ptr_array_index(targets, i);
+        settled = t->last < 0 || dmi_sim_get_value(t->disp, t->code) == t->last;
+    }
+
+    gint64 waited = g_get_monotonic_time() - settle_start;
+    if (!settled && waited < STRESS_SETTLE_MS * 1000) return G_SOURCE_CONTINUE;
+
+    stress_report(settled);
+    g_ptr_array_set_size(targets, 0);
+    g_ptr_array_set_size(dropdowns, 0);
+    g_application_quit(stress_app);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean stress_first_frame(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    first_frame = g_get_monotonic_time();
+    return G_SOURCE_REMOVE;
+}
+
+void dmi_stress_watch_window(GtkWidget *window) {
+    if (!targets || first_frame > 0 || !window) return;
+
+    gtk_widget_add_tick_callback(window, stress_first_frame, NULL, NULL);
+}
+
+static gboolean stress_frame_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    gint64 frame_time = gdk_frame_clock_get_frame_time(clock);
+
+    if (last_frame > 0) {
+        gint64 interval = frame_time - last_frame;
+        g_array_append_val(frame_intervals, interval);
+    }
+    last_frame = frame_time;
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean stress_drive(gpointer data) {
+    gint64 now = g_get_monotonic_time();
+
+    max_gap = MAX(max_gap, now - last_dispatch);
+    last_dispatch = now;
+    ticks++;
+
+    for (guint i = 0; i < targets->len; i++) {
+        StressTarget *t = g_ptr_array_index(targets, i);
+        GtkAdjustment *adj = gtk_range_get_adjustment(GTK_RANGE(t->scale));
+        int max = (int)gtk_adjustment_get_upper(adj);
+        int value = (int)gtk_range_get_value(GTK_RANGE(t->scale));
+
+        /* Mostly small drags with the occasional jump, like a hand on a slider */
+        int step = MAX(1, max / 16);
+        int next = value + g_rand_int_range(rng, -step, step + 1);
+        if (g_rand_int_range(rng, 0, 32) == 0) next = g_rand_int_range(rng, 0, max + 1);
+        next = CLAMP(next, 0, max);
+        if (next == value) continue;
+
+        gtk_range_set_value(GTK_RANGE(t->scale), next);
+        t->requested++;
+        t->last = next;
+    }
+
+    for (guint i = 0; i < dropdowns->len && ticks % DMI_STRESS_RATE_HZ == 0; i++) {
+        GtkWidget *dropdown = g_ptr_array_index(dropdowns, i);
+        GListModel *model = gtk_drop_down_get_model(GTK_DROP_DOWN(dropdown));
+        guint n = model ? g_list_model_get_n_items(model) : 0;
+
+        /* The dropdown stays insensitive while a switch is in flight */
+        if (n < 2 || !gtk_widget_get_sensitive(dropdown)) continue;
+
+        guint next = (gtk_drop_down_get_selected(GTK_DROP_DOWN(dropdown)) + 1) % n;
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(dropdown), next);
+        switches++;
+    }
+
+    if (now - start_time < (gint64)stress_seconds * G_USEC_PER_SEC) return G_SOURCE_CONTINUE;
+
+    drive_id = 0;
+    drive_elapsed = now - start_time;
+    cpu_used = cpu_time_us() - cpu_start;
+    gtk_widget_remove_tick_callback(stress_window, tick_cb_id);
+    tick_cb_id = 0;
+
+    settle_start = g_get_monotonic_time();
+    g_timeout_add(STRESS_SETTLE_POLL_MS, stress_settle, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+void dmi_stress_start(GApplication *app, GtkWidget *window) {
+    if (!targets || drive_id > 0) return;
+
+    stress_app = app;
+    stress_window = window;
+
+    if (targets->len == 0) {
+        stress_fail("no scales to drive");
+        g_application_quit(app);
+        return;
+    }
+
+    for (guint i = 0; i < targets->len; i++) {
+        StressTarget *t = g_ptr_array_index(targets, i);
+        t->writes_before = dmi_sim_get_writes(t->disp, t->code);
+    }
+
+    g_print("stress: driving %u scales at %d Hz for %u s\n", targets->len, DMI_STRESS_RATE_HZ,
+            stress_seconds);
+
+    cpu_start = cpu_time_us();
+    start_time = last_dispatch = g_get_monotonic_time();
+    tick_cb_id = gtk_widget_add_tick_callback(window, stress_frame_tick, NULL, NULL);
+    drive_id = g_timeout_add(1000 / DMI_STRESS_RATE_HZ, stress_drive, NULL);
+}
+
+int dmi_stress_status(void) {
+    return status;
+}
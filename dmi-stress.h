@@ -0,0 +1,36 @@
+#ifndef DMI_STRESS_H
+#define DMI_STRESS_H
+
+#include "dmi-api.h"
+
+#include <gtk/gtk.h>
+
+/*
+ * Slider-drag stress run against simulated displays. Registered scales are moved at
+ * DMI_STRESS_RATE_HZ for the requested number of seconds while main loop dispatch gaps,
+ * frame clock intervals and issued writes are recorded. Once input stops, every display
+ * must settle on the last requested value. Startup time to the first frame and CPU time
+ * per change are reported for benchmarking. The report goes to stdout and
+ * dmi_stress_status() is non-zero if any limit was exceeded.
+ */
+
+#define DMI_STRESS_RATE_HZ 125
+
+void dmi_stress_init(guint seconds);
+gboolean dmi_stress_enabled(void);
+
+/* Adds a scale whose value-changed handler writes code on disp */
+void dmi_stress_register(GtkWidget *scale, dmi_display *disp, guint8 code);
+/* Adds an input dropdown, stepped to its next entry once a second */
+void dmi_stress_register_dropdown(GtkWidget *dropdown);
+
+/* Records the first frame of window, which is what "first frame after startup" reports;
+ * call as soon as the window exists, before any probe has returned */
+void dmi_stress_watch_window(GtkWidget *window);
+
+/* Starts driving the registered scales; quits app when the run is over */
+void dmi_stress_start(GApplication *app, GtkWidget *window);
+
+int dmi_stress_status(void);
+
+#endif
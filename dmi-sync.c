@@ -0,0 +1,218 @@
+#include "dmi-sync.h"
+#include "dmi-sched.h"
+
+#include <ddcutil_status_codes.h>
+
+#define VCP_NEW_CONTROL_VALUE 0x02
+#define VCP_ACTIVE_CONTROL 0x52
+#define VCP_INPUT 0x60
+#define NCV_NONE 0x01
+#define NCV_PENDING 0x02
+#define NCV_NO_USER_CONTROLS 0xFF
+
+#define SYNC_MIN_MS 500
+#define SYNC_MAX_MS 4000
+#define SYNC_FALLBACK_MS 10000
+#define SYNC_MAX_FAILURES 3
+#define SYNC_MAX_CHANGES 8
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-SYNC] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef enum {
+    SYNC_PROBE,
+    SYNC_MCCS,
+    SYNC_FALLBACK,
+} SyncMode;
+
+typedef struct {
+    dmi_display *disp;
+    SyncMode mode;
+    guint failures;
+    guint interval_ms;
+    guint timeout_id;
+    gboolean in_flight;
+    guint8 changed[SYNC_MAX_CHANGES];
+    guint n_changed;
+} SyncDisplay;
+
+/* What the fallback re-reads: the features the UI has controls for */
+static const guint8 fallback_codes[] = {0x10, 0x12, 0x14, 0x62, 0x16, 0x18, 0x1a, 0x60};
+
+static GPtrArray *sync_displays = NULL;
+static gboolean sync_running = FALSE;
+static dmi_sync_func sync_func = NULL;
+static gpointer sync_data = NULL;
+
+static void sync_arm(SyncDisplay *s);
+
+static void sync_add_changed(SyncDisplay *s, guint8 code) {
+    for (guint i = 0; i < s->n_changed; i++) {
+        if (s->changed[i] == code) return;
+    }
+    if (s->n_changed < SYNC_MAX_CHANGES) s->changed[s->n_changed++] = code;
+}
+
+/* The input is cached as a known_inputs code rather than as a feature value */
+static void sync_reread_input(SyncDisplay *s) {
+    dmi_display_values v;
+    dmi_display_snapshot(s->disp, &v);
+    if (v.input_val < 0) return;
+
+    int now = dmi_display_get_input(s->disp, NULL);
+    if (now >= 0 && now != v.input_val) sync_add_changed(s, VCP_INPUT);
+}
+
+/* Re-reads the given features and remembers the ones whose value moved */
+static void sync_reread(SyncDisplay *s, const guint8 *codes, guint n) {
+    for (guint i = 0; i < n; i++) {
+        guint16 before, max, cur;
+
+        if (codes[i] == VCP_INPUT) {
+            sync_reread_input(s);
+            continue;
+        }
+
+        /* Without a cached value (e.g. 0x60) there is nothing to compare the read with */
+        if (!dmi_display_cached_vcp(s->disp, codes[i], &before, &max)) continue;
+        /* Features the UI never showed stay untouched in the fallback */
+        if (max == 0 && s->mode == SYNC_FALLBACK) continue;
+
+        if (dmi_display_read_vcp(s->disp, codes[i], &cur, &max, NULL) == 0 && cur != before) {
+            sync_add_changed(s, codes[i]);
+        }
+    }
+}
+
+/* Runs on the bus worker */
+static void sync_job(dmi_display *disp, gpointer data) {
+    SyncDisplay *s = data;
+    guint16 ncv, max;
+
+    if (s->mode == SYNC_FALLBACK) {
+        sync_reread(s, fallback_codes, G_N_ELEMENTS(fallback_codes));
+        return;
+    }
+
+    int rc = dmi_display_read_vcp(disp, VCP_NEW_CONTROL_VALUE, &ncv, &max, NULL);
+    if (rc != 0 || (ncv & 0xFF) == NCV_NO_USER_CONTROLS) {
+        if (rc == 0 || rc == DDCRC_REPORTED_UNSUPPORTED || ++s->failures >= SYNC_MAX_FAILURES) {
+            DEBUG_PRINT("%s: no usable VCP 0x02 (%d), falling back\n", disp->info.model_name,
+                        rc);
+            s->mode = SYNC_FALLBACK;
+        }
+        return;
+    }
+
+    s->mode = SYNC_MCCS;
+    s->failures = 0;
+    if ((ncv & 0xFF) != NCV_PENDING) return;
+
+    /* 0x52 hands out the changed codes one per read until it returns 0 */
+    guint8 codes[SYNC_MAX_CHANGES];
+    guint n = 0;
+    while (n < SYNC_MAX_CHANGES) {
+        guint16 code;
+        if (dmi_display_read_vcp(disp, VCP_ACTIVE_CONTROL, &code, &max, NULL) != 0) break;
+        if ((code & 0xFF) == 0) break;
+        codes[n++] = code & 0xFF;
+    }
+
+    DEBUG_PRINT("%s: %u controls changed on the monitor\n", disp->info.model_name, n);
+
+    if (n > 0) {
+        sync_reread(s, codes, n);
+    } else {
+        sync_reread(s, fallback_codes, G_N_ELEMENTS(fallback_codes));
+    }
+
+    dmi_display_set_vcp_value(disp, VCP_NEW_CONTROL_VALUE, NCV_NONE, NULL);
+}
+
+static gboolean sync_job_done(gpointer data) {
+    SyncDisplay *s = data;
+
+    s->in_flight = FALSE;
+
+    for (guint i = 0; i < s->n_changed && sync_func; i++) {
+        sync_func(s->disp, s->changed[i], sync_data);
+    }
+
+    if (s->mode == SYNC_FALLBACK) {
+        s->interval_ms = SYNC_FALLBACK_MS;
+    } else if (s->n_changed > 0) {
+        /* Someone is at the buttons; expect more */
+        s->interval_ms = SYNC_MIN_MS;
+    } else {
+        s->interval_ms = MIN(s->interval_ms * 2, SYNC_MAX_MS);
+    }
+
+    if (sync_running) sync_arm(s);
+    return G_SOURCE_REMOVE;
+}
+
+static void sync_job_finish(gpointer data) {
+    g_idle_add(sync_job_done, data);
+}
+
+static gboolean sync_tick(gpointer data) {
+    SyncDisplay *s = data;
+
+    s->timeout_id = 0;
+    s->in_flight = TRUE;
+    /* Here rather than in the job, which a drop of the display skips */
+    s->n_changed = 0;
+    dmi_sched_submit(s->disp, DMI_SCHED_BACKGROUND, DMI_SCHED_KEY_SYNC, sync_job, s,
+                     sync_job_finish);
+    return G_SOURCE_REMOVE;
+}
+
+static void sync_arm(SyncDisplay *s) {
+    if (s->timeout_id == 0 && !s->in_flight) {
+        s->timeout_id = g_timeout_add(s->interval_ms, sync_tick, s);
+    }
+}
+
+void dmi_sync_start(dmi_display_list *dlist, dmi_sync_func func, gpointer user_data) {
+    if (!dlist) return;
+
+    if (!sync_displays) {
+        sync_displays = g_ptr_array_new_with_free_func(g_free);
+
+        for (guint i = 0; i < dlist->ct; i++) {
+            SyncDisplay *s = g_new0(SyncDisplay, 1);
+            s->disp = dmi_display_list_get(dlist, i);
+            s->mode = SYNC_PROBE;
+            g_ptr_array_add(sync_displays, s);
+        }
+    }
+
+    sync_func = func;
+    sync_data = user_data;
+    sync_running = TRUE;
+
+    /* Check soon after the window appears; the value may have changed while it was hidden */
+    for (guint i = 0; i < sync_displays->len; i++) {
+        SyncDisplay *s = g_ptr_array_index(sync_displays, i);
+        s->interval_ms = s->mode == SYNC_FALLBACK ? SYNC_FALLBACK_MS : SYNC_MIN_MS;
+        sync_arm(s);
+    }
+}
+
+void dmi_sync_stop(void) {
+    if (!sync_displays) return;
+
+    sync_running = FALSE;
+
+    for (guint i = 0; i < sync_displays->len; i++) {
+        SyncDisplay *s = g_ptr_array_index(sync_displays, i);
+        if (s->timeout_id > 0) {
+            g_source_remove(s->timeout_id);
+            s->timeout_id = 0;
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef DMI_SYNC_H
+#define DMI_SYNC_H
+
+#include "dmi-api.h"
+
+/*
+ * Picks up changes made with the monitor's own buttons while the window is visible. Each
+ * display is polled with a single read of VCP 0x02 (New Control Value) at an interval that
+ * shrinks after a change and grows while nothing happens. When the monitor flags a change,
+ * VCP 0x52 (Active Control) names the features to re-read, and 0x02 is reset afterwards.
+ * Monitors without 0x02 get a throttled re-read of the features the UI shows instead.
+ */
+
+/* Called on the main thread for every feature whose cached value changed */
+typedef void (*dmi_sync_func)(dmi_display *disp, guint8 code, gpointer user_data);
+
+void dmi_sync_start(dmi_display_list *dlist, dmi_sync_func func, gpointer user_data);
+void dmi_sync_stop(void);
+
+#endif
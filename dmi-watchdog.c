@@ -0,0 +1,225 @@
+#include "dmi-watchdog.h"
+
+#include <stdio.h>
+
+#define DEBUG_MODE 0
+
+#if DEBUG_MODE
+#define DEBUG_PRINT(fmt, ...) g_print("[DMI-WATCHDOG] " fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...) ((void)0)
+#endif
+
+typedef struct {
+    const char *op;
+    dmi_display *disp;
+    guint8 code;
+} WatchedOp;
+
+static GMutex wd_lock;
+static GCond wd_cond;
+static GThread *wd_thread = NULL;
+static GThread *main_thread = NULL;
+static GPollFunc default_poll = NULL;
+static gboolean hook_installed = FALSE;
+static guint wakeups = 0;
+static guint wakeup_interval_sec = 0;
+static guint wakeup_report_id = 0;
+static gint64 threshold_us = 0;
+static gboolean running = FALSE;
+
+/* Protected by wd_lock */
+static gboolean dispatching = FALSE;
+static guint64 dispatch_seq = 0;
+static gint64 dispatch_start = 0;
+static gboolean stalled = FALSE;
+static WatchedOp current_op;
+static guint stall_count = 0;
+static GHashTable *stalls_by_op = NULL;
+
+static gint watchdog_poll(GPollFD *fds, guint nfds, gint timeout) {
+    if (!wd_thread) {
+        gint ret = default_poll(fds, nfds, timeout);
+        wakeups++;
+        return ret;
+    }
+
+    gboolean report = FALSE;
+    gint64 blocked = 0;
+
+    g_mutex_lock(&wd_lock);
+    if (stalled) {
+        report = TRUE;
+        blocked = g_get_monotonic_time() - dispatch_start;
+        stalled = FALSE;
+    }
+    dispatching = FALSE;
+    g_mutex_unlock(&wd_lock);
+
+    if (report) {
+        g_printerr("WARNING: main loop was blocked for %" G_GINT64_FORMAT " ms\n", blocked / 1000);
+    }
+
+    gint ret = default_poll(fds, nfds, timeout);
+    wakeups++;
+
+    g_mutex_lock(&wd_lock);
+    dispatching = TRUE;
+    dispatch_seq++;
+    dispatch_start = g_get_monotonic_time();
+    g_cond_signal(&wd_cond);
+    g_mutex_unlock(&wd_lock);
+
+    return ret;
+}
+
+static void watchdog_record_stall(gint64 now) {
+    const char *op = current_op.op ? current_op.op : "(outside dmi-api)";
+
+    stall_count++;
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(stalls_by_op, op));
+    g_hash_table_insert(stalls_by_op, (gpointer)op, GUINT_TO_POINTER(n + 1));
+
+    if (!current_op.op) {
+        g_printerr("WARNING: main loop stalled for %" G_GINT64_FORMAT " ms outside dmi-api\n",
+                   (now - dispatch_start) / 1000);
+        return;
+    }
+
+    char vcp[16] = "";
+    if (current_op.code) snprintf(vcp, sizeof(vcp), ", VCP 0x%02x", current_op.code);
+
+    g_printerr("WARNING: main loop stalled for %" G_GINT64_FORMAT " ms in %s (%s %s%s)\n",
+               (now - dispatch_start) / 1000, op,
+               current_op.disp ? current_op.disp->info.model_name : "no display",
+               current_op.disp ? current_op.disp->id : "", vcp);
+}
+
+static gpointer watchdog_thread(gpointer data) {
+    g_mutex_lock(&wd_lock);
+
+    while (running) {
+        if (!dispatching || stalled) {
+            g_cond_wait(&wd_cond, &wd_lock);
+            continue;
+        }
+
+        guint64 seq = dispatch_seq;
+        gint64 deadline = dispatch_start + threshold_us;
+
+        while (running && dispatching && dispatch_seq == seq &&
+               g_get_monotonic_time() < deadline) {
+            g_cond_wait_until(&wd_cond, &wd_lock, deadline);
+        }
+
+        if (running && dispatching && dispatch_seq == seq) {
+            /* One report per stall; the poll hook clears the flag when the loop resumes */
+            stalled = TRUE;
+            watchdog_record_stall(g_get_monotonic_time());
+        }
+    }
+
+    g_mutex_unlock(&wd_lock);
+    return NULL;
+}
+
+static void watchdog_install_hook(void) {
+    if (hook_installed) return;
+
+    GMainContext *ctx = g_main_context_default();
+    default_poll = g_main_context_get_poll_func(ctx);
+    g_main_context_set_poll_func(ctx, watchdog_poll);
+    hook_installed = TRUE;
+}
+
+void dmi_watchdog_start(guint threshold_ms) {
+    if (wd_thread || threshold_ms == 0) return;
+
+    main_thread = g_thread_self();
+    threshold_us = (gint64)threshold_ms * G_TIME_SPAN_MILLISECOND;
+    stalls_by_op = g_hash_table_new(g_str_hash, g_str_equal);
+    running = TRUE;
+
+    watchdog_install_hook();
+
+    wd_thread = g_thread_new("dmi-watchdog", watchdog_thread, NULL);
+    DEBUG_PRINT("Watching main loop, threshold %u ms\n", threshold_ms);
+}
+
+static void print_op_count(gpointer key, gpointer value, gpointer user_data) {
+    g_printerr("  %u x %s\n", GPOINTER_TO_UINT(value), (const char *)key);
+}
+
+static gboolean report_wakeups(gpointer data) {
+    /* This report is itself one of the wakeups it counts */
+    g_print("Main loop wakeups: %u in %u s (%.1f per minute)\n", wakeups, wakeup_interval_sec,
+            wakeups * 60.0 / wakeup_interval_sec);
+    wakeups = 0;
+    return G_SOURCE_CONTINUE;
+}
+
+void dmi_watchdog_count_wakeups(guint interval_sec) {
+    if (wakeup_report_id > 0 || interval_sec == 0) return;
+
+    watchdog_install_hook();
+    wakeups = 0;
+    wakeup_interval_sec = interval_sec;
+    wakeup_report_id = g_timeout_add_seconds(interval_sec, report_wakeups, NULL);
+}
+
+void dmi_watchdog_stop(void) {
+    if (wakeup_report_id > 0) {
+        g_source_remove(wakeup_report_id);
+        wakeup_report_id = 0;
+    }
+
+    if (hook_installed) {
+        g_main_context_set_poll_func(g_main_context_default(), default_poll);
+        hook_installed = FALSE;
+    }
+
+    if (!wd_thread) return;
+
+    g_mutex_lock(&wd_lock);
+    running = FALSE;
+    g_cond_signal(&wd_cond);
+    g_mutex_unlock(&wd_lock);
+
+    g_thread_join(wd_thread);
+    wd_thread = NULL;
+
+    if (stall_count > 0) {
+        g_printerr("Main loop stalled %u times:\n", stall_count);
+        g_hash_table_foreach(stalls_by_op, print_op_count, NULL);
+    }
+
+    g_hash_table_destroy(stalls_by_op);
+    stalls_by_op = NULL;
+}
+
+void dmi_watchdog_op_begin(const char *op, dmi_display *disp, guint8 code) {
+    if (!wd_thread || g_thread_self() != main_thread) return;
+
+    g_mutex_lock(&wd_lock);
+    current_op.op = op;
+    current_op.disp = disp;
+    current_op.code = code;
+    g_mutex_unlock(&wd_lock);
+}
+
+void dmi_watchdog_op_end(void) {
+    if (!wd_thread || g_thread_self() != main_thread) return;
+
+    g_mutex_lock(&wd_lock);
+    current_op.op = NULL;
+    current_op.disp = NULL;
+    current_op.code = 0;
+    g_mutex_unlock(&wd_lock);
+}
+
+guint dmi_watchdog_stall_count(void) {
+    g_mutex_lock(&wd_lock);
+    guint n = stall_count;
+    g_mutex_unlock(&wd_lock);
+    return n;
+}
@@ -0,0 +1,25 @@
+#ifndef DMI_WATCHDOG_H
+#define DMI_WATCHDOG_H
+
+#include "dmi-api.h"
+
+/*
+ * Main loop stall watchdog. A poll hook on the default main context marks when GTK
+ * leaves poll() to dispatch; a helper thread reports any dispatch that runs longer than
+ * the threshold, naming the dmi-api operation the main thread was blocked in. The same
+ * hook can count main loop wakeups to check that an idle instance really sleeps.
+ */
+
+void dmi_watchdog_start(guint threshold_ms);
+void dmi_watchdog_stop(void);
+
+/* Measurement mode: prints how often the main loop woke up, every interval_sec seconds */
+void dmi_watchdog_count_wakeups(guint interval_sec);
+
+/* Brackets a blocking dmi-api operation; only calls made on the main thread are tracked */
+void dmi_watchdog_op_begin(const char *op, dmi_display *disp, guint8 code);
+void dmi_watchdog_op_end(void);
+
+guint dmi_watchdog_stall_count(void);
+
+#endif
@@ -1,14 +1,41 @@
 #include "dmi-api.h"
-
+#include "dmi-async.h"
+#include "dmi-broker.h"
+#include "dmi-control.h"
+#include "dmi-curve.h"
+#include "dmi-journal.h"
+#include "dmi-parse.h"
+#include "dmi-sched.h"
+#include "dmi-sim.h"
+#include "dmi-soak.h"
+#include "dmi-state.h"
+#include "dmi-stress.h"
+#include "dmi-sync.h"
+#include "dmi-watchdog.h"
+
+#include <ddcutil_status_codes.h>
+#include <glib-unix.h>
 #include <gtk/gtk.h>
 #include <math.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #define WINDOW_WIDTH 550
 #define AUTO_CLOSE_DELAY_SEC 3
+#define NOTEBOOK_MAX_DISPLAYS 4
+#define OVERVIEW_HEIGHT 420
+#define SIM_DEFAULT_DISPLAYS 2
+#define SIM_DEFAULT_LATENCY_MS 50
+#define WATCHDOG_DEFAULT_MS 250
+#define WAKEUP_REPORT_SEC 60
+#define RELEASE_AFTER_DEFAULT_SEC 300
 #define DEBUG_MODE 0
 
 #if DEBUG_MODE
@@ -42,62 +69,91 @@ typedef struct {
     GtkWidget *contrast_scale;
     GtkWidget *ctemp_label;
     GtkWidget *ctemp_combo;
+    GtkWidget *rgb_label;
+    GtkWidget *red_scale;
+    GtkWidget *green_scale;
+    GtkWidget *blue_scale;
     GtkWidget *volume_label;
     GtkWidget *volume_scale;
     GtkWidget *input_combo;
     DisplayWrapper *wrapper;
+    GtkWidget *input_pill;
     GArray *supported_inputs;
     GtkNotebook *notebook;
     guint display_number;
+    /* Probe jobs still out; a section freed meanwhile is only orphaned until they return */
+    guint probes_pending;
+    gboolean orphaned;
+    /* Counted in sections_probing until its startup probes are back */
+    gboolean startup;
+    /* The capabilities fetch for the input list is out */
+    gboolean inputs_loading;
 } DisplaySection;
 
 static gboolean mouse_inside = FALSE;
-static gint64 mouse_leave_time = 0;
 static guint close_timeout_id = 0;
 
 static GtkWidget *main_window = NULL;
 static dmi_display_list *global_dlist = NULL;
+static gboolean displays_detecting = FALSE;
+static gboolean displays_detected = FALSE;
+static GtkCssProvider *css_provider = NULL;
+
+static guint release_after_sec = RELEASE_AFTER_DEFAULT_SEC;
+static guint release_timeout_id = 0;
+static gboolean ui_released = FALSE;
+static guint ui_jobs_in_flight = 0;
+static guint sections_probing = 0;
+static gint64 ui_build_us = 0;
+
+static gint sim_displays = 0;
+static gint sim_latency_ms = SIM_DEFAULT_LATENCY_MS;
+static gint stress_seconds = 0;
+static gint soak_minutes = 0;
+static gint watchdog_ms = WATCHDOG_DEFAULT_MS;
+static gboolean count_wakeups = FALSE;
+static gboolean broker = FALSE;
+static gint journal_entries = 0;
+static gchar *replay_path = NULL;
+static gchar *parse_kind = NULL;
+
+static const GOptionEntry option_entries[] = {
+    {"simulate", 0, 0, G_OPTION_ARG_INT, &sim_displays, "Use N simulated displays", "N"},
+    {"sim-latency", 0, 0, G_OPTION_ARG_INT, &sim_latency_ms,
+     "Milliseconds per simulated DDC transaction", "MS"},
+    {"stress", 0, 0, G_OPTION_ARG_INT, &stress_seconds,
+     "Drive the sliders for SECONDS and report responsiveness", "SECONDS"},
+    {"soak", 0, 0, G_OPTION_ARG_INT, &soak_minutes,
+     "Cycle simulated activity for MINUTES and fail on resource growth", "MINUTES"},
+    {"watchdog", 0, 0, G_OPTION_ARG_INT, &watchdog_ms,
+     "Report main loop stalls longer than MS (0 disables)", "MS"},
+    {"count-wakeups", 0, 0, G_OPTION_ARG_NONE, &count_wakeups,
+     "Print main loop wakeups once a minute", NULL},
+    {"broker", 0, 0, G_OPTION_ARG_NONE, &broker,
+     "Serve DDC requests from other tools on a Unix socket", NULL},
+    {"journal", 0, 0, G_OPTION_ARG_INT, &journal_entries,
+     "Keep the last N DDC operations and dump them on SIGUSR2", "N"},
+    {"replay", 0, 0, G_OPTION_ARG_FILENAME, &replay_path,
+     "Replay a DDC journal against simulated displays", "FILE"},
+    {"parse", 0, 0, G_OPTION_ARG_STRING, &parse_kind,
+     "Parse ddcutil detect, caps or getvcp output from stdin and exit", "KIND"},
+    {NULL}};
 
-static int get_current_color_temp_preset(dmi_display *disp) {
-    if (!disp || !disp->dh) return -1;
-
-    DDCA_Non_Table_Vcp_Value valrec;
-    DDCA_Status rc = ddca_get_non_table_vcp_value(disp->dh, 0x14, &valrec);
-
-    if (rc == 0) {
-        return valrec.sl;
-    }
-
-    if (disp->i2c_busno >= 0) {
-        char cmd[128];
-        snprintf(cmd, sizeof(cmd), "ddcutil getvcp 14 --bus=%d 2>/dev/null", disp->i2c_busno);
-
-        FILE *fp = popen(cmd, "r");
-        if (!fp) return -1;
-
-        char line[512];
-        int value = -1;
-
-        while (fgets(line, sizeof(line), fp)) {
-            if (strstr(line, "current value") != NULL) {
-                char *eq = strchr(line, '=');
-                if (eq && sscanf(eq + 1, " 0x%x", &value) == 1) {
-                    break;
-                }
-            }
-        }
-
-        pclose(fp);
-        return value;
-    }
+static int set_color_temp_preset(dmi_display *disp, guint8 preset_code) {
+    if (!disp) return -1;
 
-    return -1;
+    return dmi_display_set_vcp_value(disp, 0x14, preset_code, NULL);
 }
 
-static int set_color_temp_preset(dmi_display *disp, guint8 preset_code) {
-    if (!disp) return -1;
+static void color_temp_job(dmi_display *disp, gpointer data) {
+    guint selected = GPOINTER_TO_UINT(data);
 
-    return dmi_display_set_vcp_value(disp, 0x14, preset_code);
+    int rc = set_color_temp_preset(disp, color_temp_presets[selected].code);
+    if (rc != 0) {
+        g_printerr("Failed to set color temperature preset: %d\n", rc);
+    } else {
+        g_print("Color temperature set to %s\n", color_temp_presets[selected].name);
+    }
 }
 
 static void on_color_temp_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer user_data) {
@@ -112,12 +168,9 @@ static void on_color_temp_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpoi
 
     DEBUG_PRINT("Setting color temperature to: 0x%02x (%s)\n", preset_code, preset_name);
 
-    int rc = set_color_temp_preset(disp, preset_code);
-    if (rc != 0) {
-        g_printerr("Failed to set color temperature preset: %d\n", rc);
-    } else {
-        g_print("Color temperature set to %s\n", preset_name);
-    }
+    dmi_curve_pause(disp);
+    dmi_sched_submit(disp, DMI_SCHED_INTERACTIVE, DMI_SCHED_KEY_VCP(0x14), color_temp_job,
+                     GUINT_TO_POINTER(selected), NULL);
 }
 
 static void on_brightness_changed(GtkRange *range, gpointer user_data);
@@ -133,16 +186,39 @@ static void display_section_free(DisplaySection *section);
 static void display_section_attach_to_notebook(DisplaySection *section, GtkNotebook *notebook,
                                                const char *display_name, const char *input_name);
 static int get_input_code_from_index(guint index);
+static const char *input_name_for_code(int code);
+static void on_control_command(const char *command, dmi_control_request *req,
+                               gpointer user_data);
+
+static void brightness_job(dmi_display *disp, gpointer data) {
+    int rc = dmi_display_set_brightness(disp, GPOINTER_TO_UINT(data), NULL);
+    if (rc != 0) {
+        g_printerr("Failed to set brightness: %d\n", rc);
+    }
+}
+
+static void contrast_job(dmi_display *disp, gpointer data) {
+    int rc = dmi_display_set_contrast(disp, GPOINTER_TO_UINT(data), NULL);
+    if (rc != 0) {
+        g_printerr("Failed to set contrast: %d\n", rc);
+    }
+}
+
+static void volume_job(dmi_display *disp, gpointer data) {
+    int rc = dmi_display_set_volume(disp, GPOINTER_TO_UINT(data), NULL);
+    if (rc != 0) {
+        g_printerr("Failed to set volume: %d\n", rc);
+    }
+}
 
 static void on_brightness_changed(GtkRange *range, gpointer user_data) {
     dmi_display *disp = user_data;
     if (!disp) return;
 
     guint16 new_val = (guint16)gtk_range_get_value(range);
-    int rc = dmi_display_set_brightness(disp, new_val);
-    if (rc != 0) {
-        g_printerr("Failed to set brightness: %d\n", rc);
-    }
+    dmi_curve_pause(disp);
+    dmi_sched_submit(disp, DMI_SCHED_INTERACTIVE, DMI_SCHED_KEY_VCP(0x10), brightness_job,
+                     GUINT_TO_POINTER(new_val), NULL);
 }
 
 static void on_contrast_changed(GtkRange *range, gpointer user_data) {
@@ -150,21 +226,58 @@ static void on_contrast_changed(GtkRange *range, gpointer user_data) {
     if (!disp) return;
 
     guint16 new_val = (guint16)gtk_range_get_value(range);
-    int rc = dmi_display_set_contrast(disp, new_val);
+    dmi_sched_submit(disp, DMI_SCHED_INTERACTIVE, DMI_SCHED_KEY_VCP(0x12), contrast_job,
+                     GUINT_TO_POINTER(new_val), NULL);
+}
+
+typedef struct {
+    guint16 red;
+    guint16 green;
+    guint16 blue;
+} RgbGains;
+
+static void rgb_gain_job(dmi_display *disp, gpointer data) {
+    RgbGains *gains = data;
+
+    int rc = dmi_display_set_rgb_gains(disp, gains->red, gains->green, gains->blue, NULL);
     if (rc != 0) {
-        g_printerr("Failed to set contrast: %d\n", rc);
+        g_printerr("Failed to set RGB gain: %d\n", rc);
     }
 }
 
+static void on_rgb_gain_changed(GtkRange *range, gpointer user_data) {
+    DisplaySection *section = user_data;
+    if (!section || !section->wrapper || !section->wrapper->ddc) return;
+
+    /* All channels travel together so the latest white point replaces any queued one */
+    RgbGains *gains = g_new(RgbGains, 1);
+    gains->red = (guint16)gtk_range_get_value(GTK_RANGE(section->red_scale));
+    gains->green = (guint16)gtk_range_get_value(GTK_RANGE(section->green_scale));
+    gains->blue = (guint16)gtk_range_get_value(GTK_RANGE(section->blue_scale));
+
+    dmi_sched_submit(section->wrapper->ddc, DMI_SCHED_INTERACTIVE, DMI_SCHED_KEY_RGB_GAIN,
+                     rgb_gain_job, gains, g_free);
+}
+
+static GtkWidget *gain_scale_new(guint16 max, guint16 value, const char *css_class) {
+    GtkWidget *scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, max, 1);
+    gtk_range_set_value(GTK_RANGE(scale), value);
+    gtk_scale_set_value_pos(GTK_SCALE(scale), GTK_POS_RIGHT);
+    gtk_scale_set_digits(GTK_SCALE(scale), 0);
+    gtk_scale_set_draw_value(GTK_SCALE(scale), TRUE);
+    gtk_widget_set_hexpand(scale, TRUE);
+    gtk_widget_add_css_class(scale, css_class);
+    gtk_widget_set_sensitive(scale, FALSE);
+    return scale;
+}
+
 static void on_volume_changed(GtkRange *range, gpointer user_data) {
     dmi_display *disp = user_data;
     if (!disp) return;
 
     guint16 new_val = (guint16)gtk_range_get_value(range);
-    int rc = dmi_display_set_volume(disp, new_val);
-    if (rc != 0) {
-        g_printerr("Failed to set volume: %d\n", rc);
-    }
+    dmi_sched_submit(disp, DMI_SCHED_INTERACTIVE, DMI_SCHED_KEY_VCP(0x62), volume_job,
+                     GUINT_TO_POINTER(new_val), NULL);
 }
 
 static void toggle_window_visibility() {
@@ -180,7 +293,6 @@ static void toggle_window_visibility() {
     } else {
 
         mouse_inside = TRUE;
-        mouse_leave_time = 0;
 
         gtk_widget_set_visible(main_window, TRUE);
         gtk_window_present(GTK_WINDOW(main_window));
@@ -242,53 +354,62 @@ static void update_input_dropdown_labels(DisplaySection *section, int active_cod
     }
 }
 
-static void on_input_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer user_data) {
-    DisplaySection *section = user_data;
-    if (!section || !section->wrapper || !section->wrapper->ddc) return;
-
-    guint selected = gtk_drop_down_get_selected(dropdown);
-    if (!section->supported_inputs || selected >= section->supported_inputs->len) return;
-
-    guint input_idx = g_array_index(section->supported_inputs, guint, selected);
-    if (input_idx >= known_inputs_count) return;
-
-    int input_code = known_inputs[input_idx].code;
-    const char *input_name = known_inputs[input_idx].name;
-
-    int current_input = dmi_display_get_input(section->wrapper->ddc);
-    if (current_input == input_code) {
-        DEBUG_PRINT("Input already set to 0x%02x, skipping\n", input_code);
+typedef struct {
+    DisplaySection *section;
+    GtkWidget *dropdown;
+    GtkWidget *window;
+    guint selected;
+    int input_code;
+    const char *input_name;
+    int current_input;
+    gboolean skipped;
+    int rc;
+} InputSwitch;
+
+static void input_switch_job(dmi_display *disp, gpointer data) {
+    InputSwitch *req = data;
+
+    req->current_input = dmi_display_get_input(disp, NULL);
+    if (req->current_input == req->input_code) {
+        DEBUG_PRINT("Input already set to 0x%02x, skipping\n", req->input_code);
+        req->skipped = TRUE;
+        req->rc = 0;
         return;
     }
 
-    DEBUG_PRINT("Setting input to: 0x%02x (%s)\n", input_code, input_name);
+    DEBUG_PRINT("Setting input to: 0x%02x (%s)\n", req->input_code, req->input_name);
 
-    gtk_widget_set_sensitive(GTK_WIDGET(dropdown), FALSE);
+    g_print("Switching display input to %s...\n", req->input_name);
+    g_print("Note: The display may go black temporarily during input switch.\n");
 
-    GtkRoot *root = gtk_widget_get_root(GTK_WIDGET(dropdown));
-    GtkWidget *window = root ? GTK_WIDGET(root) : NULL;
-    if (window && GTK_IS_WINDOW(window)) {
-        gtk_widget_set_cursor_from_name(window, "wait");
-    }
+    req->rc = dmi_display_set_input(disp, req->input_code, NULL);
+}
 
-    g_print("Switching display input to %s...\n", input_name);
-    g_print("Note: The display may go black temporarily during input switch.\n");
+static gboolean input_switch_done(gpointer data) {
+    InputSwitch *req = data;
+    DisplaySection *section = req->section;
+    GtkDropDown *dropdown = GTK_DROP_DOWN(req->dropdown);
 
-    int rc = dmi_display_set_input(section->wrapper->ddc, input_code);
+    ui_jobs_in_flight--;
 
-    gtk_widget_set_sensitive(GTK_WIDGET(dropdown), TRUE);
+    gtk_widget_set_sensitive(req->dropdown, TRUE);
 
-    if (window && GTK_IS_WINDOW(window)) {
-        gtk_widget_set_cursor(window, NULL);
+    if (req->window) {
+        gtk_widget_set_cursor(req->window, NULL);
     }
 
-    if (rc != 0) {
-        g_printerr("Failed to set input: %d\n", rc);
+    if (req->skipped) {
+        g_free(req);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (req->rc != 0) {
+        g_printerr("Failed to set input: %d\n", req->rc);
         g_printerr("The display may not support switching to this input via DDC/CI.\n");
 
         for (guint i = 0; i < section->supported_inputs->len; i++) {
             guint idx = g_array_index(section->supported_inputs, guint, i);
-            if (idx < known_inputs_count && known_inputs[idx].code == current_input) {
+            if (idx < known_inputs_count && known_inputs[idx].code == req->current_input) {
                 gtk_drop_down_set_selected(dropdown, i);
                 break;
             }
@@ -296,9 +417,9 @@ static void on_input_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer
     } else {
         g_print("Input switch command sent successfully.\n");
 
-        update_input_dropdown_labels(section, input_code);
+        update_input_dropdown_labels(section, req->input_code);
 
-        gtk_drop_down_set_selected(dropdown, selected);
+        gtk_drop_down_set_selected(dropdown, req->selected);
 
         if (section->notebook && section->display_number > 0) {
             int page_num = gtk_notebook_page_num(section->notebook, section->frame);
@@ -308,44 +429,87 @@ static void on_input_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer
 
                 char tab_text[128];
                 snprintf(tab_text, sizeof(tab_text), "Display %u • %s", section->display_number,
-                         input_name);
+                         req->input_name);
                 GtkWidget *tab_label = gtk_label_new(tab_text);
 
                 gtk_box_append(GTK_BOX(tab_box), tab_icon);
                 gtk_box_append(GTK_BOX(tab_box), tab_label);
 
                 gtk_notebook_set_tab_label(section->notebook, section->frame, tab_box);
+                section->input_pill = NULL;
             }
         }
     }
+
+    g_free(req);
+    return G_SOURCE_REMOVE;
+}
+
+static void input_switch_finish(gpointer data) {
+    /* Runs whether the job completed or was dropped, so the dropdown is always restored */
+    g_idle_add(input_switch_done, data);
+}
+
+static void on_input_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer user_data) {
+    DisplaySection *section = user_data;
+    if (!section || !section->wrapper || !section->wrapper->ddc) return;
+
+    guint selected = gtk_drop_down_get_selected(dropdown);
+    if (!section->supported_inputs || selected >= section->supported_inputs->len) return;
+
+    guint input_idx = g_array_index(section->supported_inputs, guint, selected);
+    if (input_idx >= known_inputs_count) return;
+
+    InputSwitch *req = g_new0(InputSwitch, 1);
+    req->section = section;
+    req->dropdown = GTK_WIDGET(dropdown);
+    req->selected = selected;
+    req->input_code = known_inputs[input_idx].code;
+    req->input_name = known_inputs[input_idx].name;
+    req->current_input = -1;
+    req->rc = -1;
+
+    gtk_widget_set_sensitive(GTK_WIDGET(dropdown), FALSE);
+
+    GtkRoot *root = gtk_widget_get_root(GTK_WIDGET(dropdown));
+    GtkWidget *window = root ? GTK_WIDGET(root) : NULL;
+    if (window && GTK_IS_WINDOW(window)) {
+        gtk_widget_set_cursor_from_name(window, "wait");
+        req->window = window;
+    }
+
+    ui_jobs_in_flight++;
+    dmi_sched_submit(section->wrapper->ddc, DMI_SCHED_INTERACTIVE, 0, input_switch_job, req,
+                     input_switch_finish);
 }
 
 static void on_mouse_motion(GtkEventControllerMotion *controller, double x, double y,
                             gpointer user_data) {
     mouse_inside = TRUE;
-    mouse_leave_time = 0;
+
+    if (close_timeout_id > 0) {
+        g_source_remove(close_timeout_id);
+        close_timeout_id = 0;
+    }
 }
 
 static void on_mouse_leave(GtkEventControllerMotion *controller, gpointer user_data) {
     mouse_inside = FALSE;
-    mouse_leave_time = g_get_monotonic_time();
 
-    if (close_timeout_id == 0) {
-        close_timeout_id = g_timeout_add_seconds(1, check_and_close, user_data);
+    /* One deadline per leave instead of a ticking check; re-entering cancels it */
+    if (close_timeout_id > 0) {
+        g_source_remove(close_timeout_id);
     }
+    close_timeout_id = g_timeout_add_seconds(AUTO_CLOSE_DELAY_SEC, check_and_close, user_data);
 }
 
 static gboolean check_and_close(gpointer data) {
-    if (!mouse_inside && mouse_leave_time > 0) {
-        gint64 now = g_get_monotonic_time();
-        if ((now - mouse_leave_time) >= AUTO_CLOSE_DELAY_SEC * G_USEC_PER_SEC) {
+    close_timeout_id = 0;
 
-            gtk_widget_set_visible(GTK_WIDGET(data), FALSE);
-            close_timeout_id = 0;
-            return G_SOURCE_REMOVE;
-        }
+    if (!mouse_inside) {
+        gtk_widget_set_visible(GTK_WIDGET(data), FALSE);
     }
-    return G_SOURCE_CONTINUE;
+    return G_SOURCE_REMOVE;
 }
 
 static int get_input_code_from_index(guint index) {
@@ -353,19 +517,296 @@ static int get_input_code_from_index(guint index) {
     return known_inputs[index].code;
 }
 
-static DisplaySection *display_section_new(dmi_display *disp) {
-    if (!disp) return NULL;
+static GtkWidget *feature_scale_new(void) {
+    GtkWidget *scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
+    gtk_range_set_value(GTK_RANGE(scale), 0);
+    gtk_scale_set_value_pos(GTK_SCALE(scale), GTK_POS_RIGHT);
+    gtk_scale_set_digits(GTK_SCALE(scale), 0);
+    gtk_scale_set_draw_value(GTK_SCALE(scale), TRUE);
+    gtk_widget_set_hexpand(scale, TRUE);
+    gtk_widget_set_sensitive(scale, FALSE);
+    return scale;
+}
+
+static int display_cached_input(dmi_display *disp) {
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+    return v.input_val;
+}
+
+/* Puts a probed value on a skeleton scale; it stays disabled if the monitor lacks the feature */
+static void scale_fill(GtkWidget *scale, GtkWidget *label, GCallback handler, gpointer data,
+                       guint16 value, guint16 max) {
+    g_signal_handlers_block_by_func(scale, handler, data);
+    gtk_range_set_range(GTK_RANGE(scale), 0, MAX(max, 1));
+    gtk_range_set_value(GTK_RANGE(scale), value);
+    g_signal_handlers_unblock_by_func(scale, handler, data);
+
+    gtk_widget_set_sensitive(scale, max > 0);
+    if (label) gtk_widget_set_sensitive(label, max > 0);
+}
+
+static void section_show_brightness(DisplaySection *section) {
+    dmi_display *disp = section->wrapper->ddc;
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
 
-    if (dmi_display_get_ctemp(disp) != 0) {
-        disp->ctemp_val = 0;
-        disp->ctemp_max = 0;
+    scale_fill(section->brightness_scale, section->brightness_label,
+               G_CALLBACK(on_brightness_changed), disp, v.brightness_val, v.brightness_max);
+    if (v.brightness_max > 0) dmi_stress_register(section->brightness_scale, disp, 0x10);
+}
+
+static void section_show_features(DisplaySection *section) {
+    dmi_display *disp = section->wrapper->ddc;
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+
+    scale_fill(section->contrast_scale, section->contrast_label, G_CALLBACK(on_contrast_changed),
+               disp, v.contrast_val, v.contrast_max);
+    if (v.contrast_max > 0) dmi_stress_register(section->contrast_scale, disp, 0x12);
+
+    guint selected_preset = 0;
+    for (guint i = 0; i < color_temp_presets_count; i++) {
+        if (color_temp_presets[i].code == (v.ctemp_val & 0xFF)) selected_preset = i;
+    }
+    g_signal_handlers_block_by_func(section->ctemp_combo, on_color_temp_changed, disp);
+    gtk_drop_down_set_selected(GTK_DROP_DOWN(section->ctemp_combo), selected_preset);
+    g_signal_handlers_unblock_by_func(section->ctemp_combo, on_color_temp_changed, disp);
+    gtk_widget_set_sensitive(section->ctemp_combo, TRUE);
+
+    gboolean gains = v.red_gain_max > 0 && v.green_gain_max > 0 && v.blue_gain_max > 0;
+    scale_fill(section->red_scale, section->rgb_label, G_CALLBACK(on_rgb_gain_changed), section,
+               v.red_gain_val, gains ? v.red_gain_max : 0);
+    scale_fill(section->green_scale, NULL, G_CALLBACK(on_rgb_gain_changed), section,
+               v.green_gain_val, gains ? v.green_gain_max : 0);
+    scale_fill(section->blue_scale, NULL, G_CALLBACK(on_rgb_gain_changed), section,
+               v.blue_gain_val, gains ? v.blue_gain_max : 0);
+    if (gains) {
+        dmi_stress_register(section->red_scale, disp, 0x16);
+        dmi_stress_register(section->green_scale, disp, 0x18);
+        dmi_stress_register(section->blue_scale, disp, 0x1a);
+    }
+
+    scale_fill(section->volume_scale, section->volume_label, G_CALLBACK(on_volume_changed), disp,
+               v.volume_val, v.volume_max);
+    if (v.volume_max > 0) dmi_stress_register(section->volume_scale, disp, 0x62);
+}
+
+/* Takes ownership of inputs */
+static void section_show_inputs(DisplaySection *section, GArray *inputs, int current_input_code) {
+    DEBUG_PRINT("Current input code: 0x%02x\n", current_input_code);
+
+    GtkDropDown *dropdown = GTK_DROP_DOWN(section->input_combo);
+    GtkStringList *str_list = GTK_STRING_LIST(gtk_drop_down_get_model(dropdown));
+
+    g_signal_handlers_block_by_func(dropdown, on_input_changed, section);
+    gtk_string_list_splice(str_list, 0, g_list_model_get_n_items(G_LIST_MODEL(str_list)), NULL);
+
+    section->supported_inputs = inputs;
+
+    guint selected_index = 0;
+    if (section->supported_inputs && section->supported_inputs->len > 0) {
+        for (guint i = 0; i < section->supported_inputs->len; i++) {
+            guint input_idx = g_array_index(section->supported_inputs, guint, i);
+            if (input_idx < known_inputs_count) {
+                char label[128];
+                snprintf(label, sizeof(label), "   %s", known_inputs[input_idx].name);
+                if (known_inputs[input_idx].code == current_input_code) selected_index = i;
+                gtk_string_list_append(str_list, label);
+            }
+        }
+        gtk_widget_set_sensitive(section->input_combo, TRUE);
+    } else {
+        gtk_string_list_append(str_list, "(None available)");
+        gtk_widget_set_sensitive(section->input_combo, FALSE);
+    }
+
+    gtk_drop_down_set_selected(dropdown, selected_index);
+    g_signal_handlers_unblock_by_func(dropdown, on_input_changed, section);
+    dmi_stress_register_dropdown(section->input_combo);
+
+    if (section->input_pill) {
+        gtk_label_set_text(GTK_LABEL(section->input_pill), input_name_for_code(current_input_code));
+    }
+}
+
+/* Until its capabilities are fetched the dropdown lists only the current input */
+static void section_show_current_input(DisplaySection *section, int current_input_code) {
+    if (section->supported_inputs) return;
+
+    GtkDropDown *dropdown = GTK_DROP_DOWN(section->input_combo);
+    GtkStringList *str_list = GTK_STRING_LIST(gtk_drop_down_get_model(dropdown));
+
+    char label[128];
+    snprintf(label, sizeof(label), "   %s", input_name_for_code(current_input_code));
+
+    g_signal_handlers_block_by_func(dropdown, on_input_changed, section);
+    gtk_string_list_splice(str_list, 0, g_list_model_get_n_items(G_LIST_MODEL(str_list)),
+                           (const char *const[]){label, NULL});
+    gtk_drop_down_set_selected(dropdown, 0);
+    g_signal_handlers_unblock_by_func(dropdown, on_input_changed, section);
+    /* Opening it loads the full list, even when the current input could not be read */
+    gtk_widget_set_sensitive(section->input_combo, TRUE);
+
+    if (section->input_pill) {
+        gtk_label_set_text(GTK_LABEL(section->input_pill), input_name_for_code(current_input_code));
+    }
+}
+
+static void sections_probed(void);
+
+/* Counts a section's startup probes down; the last one of the last section starts the runs
+ * that drive the UI */
+static void section_startup_check(DisplaySection *section) {
+    if (!section->startup || section->probes_pending > 0) return;
+
+    section->startup = FALSE;
+    if (--sections_probing == 0) sections_probed();
+}
+
+static void section_inputs_ready(GObject *source, GAsyncResult *result, gpointer data) {
+    DisplaySection *section = data;
+    GError *error = NULL;
+    GArray *inputs = dmi_display_get_supported_inputs_finish(result, &error);
+
+    ui_jobs_in_flight--;
+    section->probes_pending--;
+    section->inputs_loading = FALSE;
+
+    if (section->orphaned) {
+        if (inputs) g_array_free(inputs, TRUE);
+        if (section->probes_pending == 0) display_section_free(section);
+        g_clear_error(&error);
+        return;
+    }
+
+    /* A monitor that failed to answer is asked again the next time the dropdown opens */
+    if (inputs || g_error_matches(error, DMI_ERROR, DDCRC_REPORTED_UNSUPPORTED)) {
+        section_show_inputs(section, inputs, display_cached_input(section->wrapper->ddc));
+    }
+    g_clear_error(&error);
+
+    section_startup_check(section);
+}
+
+/* Capabilities can hold the bus for seconds and a running job cannot be interrupted, so they
+ * are fetched only once someone wants the list: from then on they come from the cache */
+static void section_load_inputs(DisplaySection *section, int io_priority) {
+    if (section->supported_inputs || section->inputs_loading) return;
+
+    section->inputs_loading = TRUE;
+    section->probes_pending++;
+    ui_jobs_in_flight++;
+    dmi_display_get_supported_inputs_async(section->wrapper->ddc, io_priority, NULL,
+                                           section_inputs_ready, section);
+}
+
+static void on_input_combo_pressed(GtkGestureClick *gesture, int n_press, double x, double y,
+                                   gpointer user_data) {
+    section_load_inputs(user_data, G_PRIORITY_DEFAULT);
+}
+
+static void on_input_combo_activate(GtkDropDown *dropdown, gpointer user_data) {
+    section_load_inputs(user_data, G_PRIORITY_DEFAULT);
+}
+
+typedef enum {
+    PROBE_BRIGHTNESS,
+    PROBE_FEATURES,
+    PROBE_INPUT,
+} ProbeStage;
+
+typedef struct {
+    DisplaySection *section;
+    ProbeStage stage;
+    gboolean ran;
+    int input_code;
+} SectionProbe;
+
+/* Runs on the bus worker, in stage order, behind any control the user is already moving */
+static void section_probe_job(dmi_display *disp, gpointer data) {
+    SectionProbe *probe = data;
+
+    switch (probe->stage) {
+    case PROBE_BRIGHTNESS:
+        if (dmi_display_get_brightness(disp, NULL) != 0) {
+            g_printerr("Failed to get brightness for display %s\n", disp->info.model_name);
+        }
+        break;
+    case PROBE_FEATURES:
+        if (dmi_display_get_contrast(disp, NULL) != 0) dmi_display_forget(disp, 0x12);
+        if (dmi_display_get_ctemp(disp, NULL) != 0) dmi_display_forget(disp, 0x14);
+        if (dmi_display_get_volume(disp, NULL) != 0) dmi_display_forget(disp, 0x62);
+        if (dmi_display_get_rgb_gains(disp, NULL) != 0) {
+            dmi_display_forget(disp, 0x16);
+            dmi_display_forget(disp, 0x18);
+            dmi_display_forget(disp, 0x1a);
+        }
+        break;
+    case PROBE_INPUT:
+        probe->input_code = dmi_display_get_input(disp, NULL);
+        break;
+    }
+
+    probe->ran = TRUE;
+}
+
+static gboolean section_probe_done(gpointer data) {
+    SectionProbe *probe = data;
+    DisplaySection *section = probe->section;
+    dmi_display *disp = section->wrapper->ddc;
+
+    ui_jobs_in_flight--;
+    section->probes_pending--;
+
+    if (section->orphaned) {
+        if (section->probes_pending == 0) display_section_free(section);
+        g_free(probe);
+        return G_SOURCE_REMOVE;
     }
 
-    if (dmi_display_get_volume(disp) != 0) {
-        disp->volume_val = 0;
-        disp->volume_max = 0;
+    if (probe->ran) {
+        switch (probe->stage) {
+        case PROBE_BRIGHTNESS:
+            section_show_brightness(section);
+            break;
+        case PROBE_FEATURES:
+            section_show_features(section);
+            break;
+        case PROBE_INPUT:
+            section_show_current_input(section, probe->input_code);
+            disp->cache_primed = TRUE;
+            break;
+        }
     }
 
+    section_startup_check(section);
+
+    g_free(probe);
+    return G_SOURCE_REMOVE;
+}
+
+static void section_probe_finish(gpointer data) {
+    g_idle_add(section_probe_done, data);
+}
+
+static void section_probe_submit(DisplaySection *section, ProbeStage stage) {
+    SectionProbe *probe = g_new0(SectionProbe, 1);
+    probe->section = section;
+    probe->stage = stage;
+    probe->input_code = -1;
+
+    section->probes_pending++;
+    ui_jobs_in_flight++;
+    dmi_sched_submit(section->wrapper->ddc, DMI_SCHED_BACKGROUND, 0, section_probe_job, probe,
+                     section_probe_finish);
+}
+
+/* Builds the controls at once. A display seen for the first time starts as a disabled skeleton
+ * that fills in as its probes come back; after a UI release everything comes from the cache. */
+static DisplaySection *display_section_new(dmi_display *disp) {
+    if (!disp) return NULL;
+
     DisplaySection *section = g_malloc0(sizeof(DisplaySection));
 
     section->wrapper = g_malloc0(sizeof(DisplayWrapper));
@@ -401,13 +842,7 @@ static DisplaySection *display_section_new(dmi_display *disp) {
     gtk_label_set_xalign(GTK_LABEL(section->brightness_label), 0.0);
     gtk_widget_set_margin_start(section->brightness_label, 8);
 
-    section->brightness_scale =
-        gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, disp->brightness_max, 1);
-    gtk_range_set_value(GTK_RANGE(section->brightness_scale), disp->brightness_val);
-    gtk_scale_set_value_pos(GTK_SCALE(section->brightness_scale), GTK_POS_RIGHT);
-    gtk_scale_set_digits(GTK_SCALE(section->brightness_scale), 0);
-    gtk_scale_set_draw_value(GTK_SCALE(section->brightness_scale), TRUE);
-    gtk_widget_set_hexpand(section->brightness_scale, TRUE);
+    section->brightness_scale = feature_scale_new();
     g_signal_connect(section->brightness_scale, "value-changed", G_CALLBACK(on_brightness_changed),
                      disp);
 
@@ -415,120 +850,71 @@ static DisplaySection *display_section_new(dmi_display *disp) {
     gtk_label_set_xalign(GTK_LABEL(section->contrast_label), 0.0);
     gtk_widget_set_margin_start(section->contrast_label, 8);
 
-    if (disp->contrast_max > 0) {
-        section->contrast_scale =
-            gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, disp->contrast_max, 1);
-        gtk_range_set_value(GTK_RANGE(section->contrast_scale), disp->contrast_val);
-        gtk_scale_set_value_pos(GTK_SCALE(section->contrast_scale), GTK_POS_RIGHT);
-        gtk_scale_set_digits(GTK_SCALE(section->contrast_scale), 0);
-        gtk_scale_set_draw_value(GTK_SCALE(section->contrast_scale), TRUE);
-        gtk_widget_set_hexpand(section->contrast_scale, TRUE);
-        g_signal_connect(section->contrast_scale, "value-changed", G_CALLBACK(on_contrast_changed),
-                         disp);
-    } else {
-
-        section->contrast_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
-        gtk_range_set_value(GTK_RANGE(section->contrast_scale), 0);
-        gtk_scale_set_value_pos(GTK_SCALE(section->contrast_scale), GTK_POS_RIGHT);
-        gtk_scale_set_digits(GTK_SCALE(section->contrast_scale), 0);
-        gtk_scale_set_draw_value(GTK_SCALE(section->contrast_scale), TRUE);
-        gtk_widget_set_hexpand(section->contrast_scale, TRUE);
-        gtk_widget_set_sensitive(section->contrast_scale, FALSE);
-        gtk_widget_set_sensitive(section->contrast_label, FALSE);
-    }
+    section->contrast_scale = feature_scale_new();
+    g_signal_connect(section->contrast_scale, "value-changed", G_CALLBACK(on_contrast_changed),
+                     disp);
 
     section->ctemp_label = gtk_label_new("Color Temperature");
     gtk_label_set_xalign(GTK_LABEL(section->ctemp_label), 0.0);
     gtk_widget_set_margin_start(section->ctemp_label, 8);
 
     GtkStringList *ctemp_list = gtk_string_list_new(NULL);
-    section->ctemp_combo = gtk_drop_down_new(G_LIST_MODEL(ctemp_list), NULL);
-
-    int current_preset = get_current_color_temp_preset(disp);
-    guint selected_preset = 0;
-
     for (guint i = 0; i < color_temp_presets_count; i++) {
         gtk_string_list_append(ctemp_list, color_temp_presets[i].name);
-
-        if (color_temp_presets[i].code == current_preset) {
-            selected_preset = i;
-        }
     }
-
-    gtk_drop_down_set_selected(GTK_DROP_DOWN(section->ctemp_combo), selected_preset);
+    section->ctemp_combo = gtk_drop_down_new(G_LIST_MODEL(ctemp_list), NULL);
     gtk_widget_set_margin_start(section->ctemp_combo, 8);
     gtk_widget_set_margin_end(section->ctemp_combo, 8);
     gtk_widget_set_margin_bottom(section->ctemp_combo, 8);
+    gtk_widget_set_sensitive(section->ctemp_combo, FALSE);
 
     g_signal_connect(section->ctemp_combo, "notify::selected", G_CALLBACK(on_color_temp_changed),
                      disp);
 
+    section->rgb_label = gtk_label_new("RGB Gain");
+    gtk_label_set_xalign(GTK_LABEL(section->rgb_label), 0.0);
+    gtk_widget_set_margin_start(section->rgb_label, 8);
+
+    section->red_scale = gain_scale_new(100, 0, "gain-red");
+    section->green_scale = gain_scale_new(100, 0, "gain-green");
+    section->blue_scale = gain_scale_new(100, 0, "gain-blue");
+
+    g_signal_connect(section->red_scale, "value-changed", G_CALLBACK(on_rgb_gain_changed),
+                     section);
+    g_signal_connect(section->green_scale, "value-changed", G_CALLBACK(on_rgb_gain_changed),
+                     section);
+    g_signal_connect(section->blue_scale, "value-changed", G_CALLBACK(on_rgb_gain_changed),
+                     section);
+
     section->volume_label = gtk_label_new("Volume");
     gtk_label_set_xalign(GTK_LABEL(section->volume_label), 0.0);
     gtk_widget_set_margin_start(section->volume_label, 8);
 
-    if (disp->volume_max > 0) {
-        section->volume_scale =
-            gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, disp->volume_max, 1);
-        gtk_range_set_value(GTK_RANGE(section->volume_scale), disp->volume_val);
-        gtk_scale_set_value_pos(GTK_SCALE(section->volume_scale), GTK_POS_RIGHT);
-        gtk_scale_set_digits(GTK_SCALE(section->volume_scale), 0);
-        gtk_scale_set_draw_value(GTK_SCALE(section->volume_scale), TRUE);
-        gtk_widget_set_hexpand(section->volume_scale, TRUE);
-        g_signal_connect(section->volume_scale, "value-changed", G_CALLBACK(on_volume_changed),
-                         disp);
-    } else {
-
-        section->volume_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
-        gtk_range_set_value(GTK_RANGE(section->volume_scale), 0);
-        gtk_scale_set_value_pos(GTK_SCALE(section->volume_scale), GTK_POS_RIGHT);
-        gtk_scale_set_digits(GTK_SCALE(section->volume_scale), 0);
-        gtk_scale_set_draw_value(GTK_SCALE(section->volume_scale), TRUE);
-        gtk_widget_set_hexpand(section->volume_scale, TRUE);
-        gtk_widget_set_sensitive(section->volume_scale, FALSE);
-        gtk_widget_set_sensitive(section->volume_label, FALSE);
-    }
+    section->volume_scale = feature_scale_new();
+    g_signal_connect(section->volume_scale, "value-changed", G_CALLBACK(on_volume_changed), disp);
 
     GtkWidget *input_label = gtk_label_new("Input Source");
     gtk_label_set_xalign(GTK_LABEL(input_label), 0.0);
     gtk_widget_set_margin_start(input_label, 8);
     gtk_widget_set_margin_bottom(input_label, 10);
 
-    section->supported_inputs = dmi_display_get_supported_inputs(disp);
-    int current_input_code = dmi_display_get_input(disp);
-    DEBUG_PRINT("Current input code: 0x%02x\n", current_input_code);
-
     GtkStringList *str_list = gtk_string_list_new(NULL);
+    gtk_string_list_append(str_list, "   …");
     section->input_combo = gtk_drop_down_new(G_LIST_MODEL(str_list), NULL);
-
-    guint selected_index = 0;
-    if (section->supported_inputs && section->supported_inputs->len > 0) {
-        for (guint i = 0; i < section->supported_inputs->len; i++) {
-            guint input_idx = g_array_index(section->supported_inputs, guint, i);
-            if (input_idx < known_inputs_count) {
-                char label[128];
-                if (known_inputs[input_idx].code == current_input_code) {
-
-                    snprintf(label, sizeof(label), "   %s", known_inputs[input_idx].name);
-                    selected_index = i;
-                } else {
-                    snprintf(label, sizeof(label), "   %s", known_inputs[input_idx].name);
-                }
-                gtk_string_list_append(str_list, label);
-            }
-        }
-    } else {
-        gtk_string_list_append(str_list, "(None available)");
-        gtk_widget_set_sensitive(section->input_combo, FALSE);
-    }
-
-    gtk_drop_down_set_selected(GTK_DROP_DOWN(section->input_combo), selected_index);
     gtk_widget_set_margin_start(section->input_combo, 8);
     gtk_widget_set_margin_end(section->input_combo, 8);
     gtk_widget_set_margin_bottom(section->input_combo, 8);
+    gtk_widget_set_sensitive(section->input_combo, FALSE);
 
     g_signal_connect(section->input_combo, "notify::selected", G_CALLBACK(on_input_changed),
                      section);
+    g_signal_connect(section->input_combo, "activate", G_CALLBACK(on_input_combo_activate),
+                     section);
+
+    GtkGesture *press = gtk_gesture_click_new();
+    gtk_event_controller_set_propagation_phase(GTK_EVENT_CONTROLLER(press), GTK_PHASE_CAPTURE);
+    g_signal_connect(press, "pressed", G_CALLBACK(on_input_combo_pressed), section);
+    gtk_widget_add_controller(section->input_combo, GTK_EVENT_CONTROLLER(press));
 
     int row = 0;
     gtk_grid_attach(GTK_GRID(grid), header_box, 0, row++, 1, 1);
@@ -538,17 +924,40 @@ static DisplaySection *display_section_new(dmi_display *disp) {
     gtk_grid_attach(GTK_GRID(grid), section->contrast_scale, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), section->ctemp_label, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), section->ctemp_combo, 0, row++, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), section->rgb_label, 0, row++, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), section->red_scale, 0, row++, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), section->green_scale, 0, row++, 1, 1);
+    gtk_grid_attach(GTK_GRID(grid), section->blue_scale, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), section->volume_label, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), section->volume_scale, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), input_label, 0, row++, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), section->input_combo, 0, row++, 1, 1);
 
+    if (disp->cache_primed) {
+        section_show_brightness(section);
+        section_show_features(section);
+        section_show_current_input(section, display_cached_input(disp));
+    } else {
+        section_probe_submit(section, PROBE_BRIGHTNESS);
+        section_probe_submit(section, PROBE_FEATURES);
+        section_probe_submit(section, PROBE_INPUT);
+    }
+
+    /* Stress and soak runs switch inputs without ever opening the dropdown */
+    if (dmi_stress_enabled() || dmi_soak_enabled()) section_load_inputs(section, G_PRIORITY_LOW);
+
     return section;
 }
 
 static void display_section_free(DisplaySection *section) {
     if (!section) return;
 
+    /* The widgets are going away; the section itself waits for its last probe to return */
+    if (section->probes_pending > 0) {
+        section->orphaned = TRUE;
+        return;
+    }
+
     DEBUG_PRINT("Freeing display section\n");
 
     if (section->supported_inputs) {
@@ -591,46 +1000,584 @@ static void display_section_attach_to_notebook(DisplaySection *section, GtkNoteb
 
     gtk_notebook_append_page(notebook, section->frame, tab_box);
 
+    section->input_pill = pill_label;
     section->notebook = notebook;
     section->display_number = gtk_notebook_get_n_pages(notebook);
 }
 
-static void on_window_destroy(GtkWidget *window, gpointer user_data) {
-    GList *sections = user_data;
+#define DMI_TYPE_DISPLAY_ITEM (dmi_display_item_get_type())
+G_DECLARE_FINAL_TYPE(DmiDisplayItem, dmi_display_item, DMI, DISPLAY_ITEM, GObject)
+
+struct _DmiDisplayItem {
+    GObject parent_instance;
+    dmi_display *disp;
+    guint number;
+    int input_code;
+    gboolean loading;
+    gboolean loaded;
+};
+
+G_DEFINE_TYPE(DmiDisplayItem, dmi_display_item, G_TYPE_OBJECT)
+
+static void dmi_display_item_class_init(DmiDisplayItemClass *klass) {}
+
+static void dmi_display_item_init(DmiDisplayItem *self) {
+    self->input_code = -1;
+}
+
+static DmiDisplayItem *dmi_display_item_new(dmi_display *disp, guint number) {
+    DmiDisplayItem *item = g_object_new(DMI_TYPE_DISPLAY_ITEM, NULL);
+    item->disp = disp;
+    item->number = number;
+    item->input_code = display_cached_input(disp);
+    item->loaded = item->input_code >= 0;
+    return item;
+}
+
+typedef struct {
+    GtkWidget *name_label;
+    GtkWidget *scale;
+    GtkWidget *input_label;
+    gulong scale_handler;
+    DmiDisplayItem *item;
+} OverviewRow;
+
+typedef struct {
+    DmiDisplayItem *item;
+    GListStore *store;
+    gboolean ran;
+    int input_code;
+} OverviewLoad;
+
+static GtkWidget *overview_stack = NULL;
+static GListStore *overview_store = NULL;
+static GtkWidget *overview_detail = NULL;
+static DisplaySection *overview_section = NULL;
+static GPtrArray *notebook_sections = NULL;
+
+static const char *input_name_for_code(int code) {
+    for (size_t i = 0; i < known_inputs_count; i++) {
+        if (known_inputs[i].code == code) return known_inputs[i].name;
+    }
+    return "Unknown";
+}
+
+static void overview_load_job(dmi_display *disp, gpointer data) {
+    OverviewLoad *load = data;
+
+    dmi_display_get_brightness(disp, NULL);
+    load->input_code = dmi_display_get_input(disp, NULL);
+    load->ran = TRUE;
+}
+
+static gboolean overview_load_done(gpointer data) {
+    OverviewLoad *load = data;
+    DmiDisplayItem *item = load->item;
+
+    /* A job dropped with its display read nothing; the next bind asks again */
+    item->loading = FALSE;
+    if (load->ran) {
+        item->input_code = load->input_code;
+        item->loaded = TRUE;
+
+        /* Putting the item back in its own place rebinds the row if it is on screen */
+        guint position = item->number - 1;
+        if (position < g_list_model_get_n_items(G_LIST_MODEL(load->store))) {
+            g_list_store_splice(load->store, position, 1, (gpointer *)&item, 1);
+        }
+    }
+
+    g_object_unref(load->item);
+    g_object_unref(load->store);
+    g_free(load);
+    return G_SOURCE_REMOVE;
+}
+
+static void overview_load_finish(gpointer data) {
+    g_idle_add(overview_load_done, data);
+}
+
+/* Rebinds the row of disp to the cache after a change made on the monitor itself */
+static void overview_sync_row(dmi_display *disp) {
+    guint n = overview_store ? g_list_model_get_n_items(G_LIST_MODEL(overview_store)) : 0;
+
+    for (guint i = 0; i < n; i++) {
+        DmiDisplayItem *item = g_list_model_get_item(G_LIST_MODEL(overview_store), i);
+
+        if (item->disp == disp && item->loaded) {
+            item->input_code = display_cached_input(disp);
+            g_list_store_splice(overview_store, i, 1, (gpointer *)&item, 1);
+        }
+        g_object_unref(item);
+    }
+}
+
+static void on_overview_brightness_changed(GtkRange *range, gpointer user_data) {
+    OverviewRow *row = user_data;
+    if (!row->item) return;
+
+    on_brightness_changed(range, row->item->disp);
+}
+
+static void overview_row_setup(GtkSignalListItemFactory *factory, GtkListItem *list_item,
+                               gpointer user_data) {
+    OverviewRow *row = g_new0(OverviewRow, 1);
+
+    GtkWidget *box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    gtk_widget_add_css_class(box, "overview-row");
+    gtk_widget_set_margin_top(box, 4);
+    gtk_widget_set_margin_bottom(box, 4);
+
+    GtkWidget *icon = gtk_image_new_from_icon_name("video-display");
+    gtk_box_append(GTK_BOX(box), icon);
+
+    row->name_label = gtk_label_new(NULL);
+    gtk_label_set_xalign(GTK_LABEL(row->name_label), 0.0);
+    gtk_label_set_width_chars(GTK_LABEL(row->name_label), 18);
+    gtk_label_set_ellipsize(GTK_LABEL(row->name_label), PANGO_ELLIPSIZE_END);
+    gtk_box_append(GTK_BOX(box), row->name_label);
+
+    row->scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
+    gtk_scale_set_value_pos(GTK_SCALE(row->scale), GTK_POS_RIGHT);
+    gtk_scale_set_digits(GTK_SCALE(row->scale), 0);
+    gtk_scale_set_draw_value(GTK_SCALE(row->scale), TRUE);
+    gtk_widget_set_hexpand(row->scale, TRUE);
+    gtk_widget_set_sensitive(row->scale, FALSE);
+    row->scale_handler = g_signal_connect(row->scale, "value-changed",
+                                          G_CALLBACK(on_overview_brightness_changed), row);
+    gtk_box_append(GTK_BOX(box), row->scale);
+
+    row->input_label = gtk_label_new(NULL);
+    gtk_label_set_width_chars(GTK_LABEL(row->input_label), 12);
+    gtk_box_append(GTK_BOX(box), row->input_label);
+
+    g_object_set_data_full(G_OBJECT(box), "overview-row", row, g_free);
+    gtk_list_item_set_child(list_item, box);
+}
+
+static void overview_row_bind(GtkSignalListItemFactory *factory, GtkListItem *list_item,
+                              gpointer user_data) {
+    GListStore *store = user_data;
+    GtkWidget *box = gtk_list_item_get_child(list_item);
+    OverviewRow *row = g_object_get_data(G_OBJECT(box), "overview-row");
+    DmiDisplayItem *item = gtk_list_item_get_item(list_item);
+    dmi_display *disp = item->disp;
+
+    row->item = item;
+
+    char name[96];
+    snprintf(name, sizeof(name), "%u • %s", item->number, disp->info.model_name);
+    gtk_label_set_text(GTK_LABEL(row->name_label), name);
+
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+
+    g_signal_handler_block(row->scale, row->scale_handler);
+    gtk_range_set_range(GTK_RANGE(row->scale), 0, MAX(v.brightness_max, 1));
+    gtk_range_set_value(GTK_RANGE(row->scale), v.brightness_val);
+    g_signal_handler_unblock(row->scale, row->scale_handler);
+    /* Like the notebook's skeleton scales: no drag before the real range is known */
+    gtk_widget_set_sensitive(row->scale, v.brightness_max > 0);
+
+    gtk_label_set_text(GTK_LABEL(row->input_label),
+                       item->loaded ? input_name_for_code(item->input_code) : "…");
+
+    /* Values are only read once a row actually becomes visible */
+    if (!item->loaded && !item->loading) {
+        item->loading = TRUE;
+
+        OverviewLoad *load = g_new0(OverviewLoad, 1);
+        load->item = g_object_ref(item);
+        load->store = g_object_ref(store);
+        load->input_code = -1;
+        dmi_sched_submit(disp, DMI_SCHED_BACKGROUND, 0, overview_load_job, load,
+                         overview_load_finish);
+    }
+}
+
+static void overview_row_unbind(GtkSignalListItemFactory *factory, GtkListItem *list_item,
+                                gpointer user_data) {
+    GtkWidget *box = gtk_list_item_get_child(list_item);
+    OverviewRow *row = g_object_get_data(G_OBJECT(box), "overview-row");
+
+    row->item = NULL;
+}
+
+static void on_overview_back(GtkButton *button, gpointer user_data) {
+    if (!overview_detail) return;
+
+    gtk_stack_set_visible_child_name(GTK_STACK(overview_stack), "overview");
+    gtk_stack_remove(GTK_STACK(overview_stack), overview_detail);
+    overview_detail = NULL;
+
+    display_section_free(overview_section);
+    overview_section = NULL;
+}
+
+static void on_overview_activate(GtkListView *list, guint position, gpointer user_data) {
+    GListModel *model = G_LIST_MODEL(gtk_list_view_get_model(list));
+    DmiDisplayItem *item = g_list_model_get_item(model, position);
+    if (!item) return;
+
+    on_overview_back(NULL, NULL);
+
+    /* Only the display being edited gets a full set of controls */
+    overview_section = display_section_new(item->disp);
+    g_object_unref(item);
+    if (!overview_section) return;
+
+    overview_detail = gtk_box_new(GTK_ORIENTATION_VERTICAL, 6);
+
+    GtkWidget *back = gtk_button_new_from_icon_name("go-previous-symbolic");
+    gtk_widget_set_halign(back, GTK_ALIGN_START);
+    g_signal_connect(back, "clicked", G_CALLBACK(on_overview_back), NULL);
+
+    gtk_box_append(GTK_BOX(overview_detail), back);
+    gtk_box_append(GTK_BOX(overview_detail), overview_section->frame);
+
+    gtk_stack_add_named(GTK_STACK(overview_stack), overview_detail, "detail");
+    gtk_stack_set_visible_child_name(GTK_STACK(overview_stack), "detail");
+}
 
-    for (GList *l = sections; l != NULL; l = l->next) {
-        display_section_free(l->data);
+static GtkWidget *overview_new(dmi_display_list *dlist) {
+    GListStore *store = g_list_store_new(DMI_TYPE_DISPLAY_ITEM);
+    for (guint i = 0; i < dlist->ct; i++) {
+        DmiDisplayItem *item = dmi_display_item_new(dmi_display_list_get(dlist, i), i + 1);
+        g_list_store_append(store, item);
+        g_object_unref(item);
     }
-    g_list_free(sections);
+
+    GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
+    g_signal_connect(factory, "setup", G_CALLBACK(overview_row_setup), NULL);
+    g_signal_connect(factory, "bind", G_CALLBACK(overview_row_bind), store);
+    g_signal_connect(factory, "unbind", G_CALLBACK(overview_row_unbind), NULL);
+
+    /* Owned by the selection model; cleared with the window */
+    overview_store = store;
+    GtkNoSelection *selection = gtk_no_selection_new(G_LIST_MODEL(store));
+    GtkWidget *list = gtk_list_view_new(GTK_SELECTION_MODEL(selection), factory);
+    g_signal_connect(list, "activate", G_CALLBACK(on_overview_activate), NULL);
+
+    GtkWidget *scrolled = gtk_scrolled_window_new();
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled), GTK_POLICY_NEVER,
+                                   GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_min_content_height(GTK_SCROLLED_WINDOW(scrolled), OVERVIEW_HEIGHT);
+    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), list);
+
+    overview_stack = gtk_stack_new();
+    gtk_stack_set_transition_type(GTK_STACK(overview_stack),
+                                  GTK_STACK_TRANSITION_TYPE_SLIDE_LEFT_RIGHT);
+    gtk_stack_add_named(GTK_STACK(overview_stack), scrolled, "overview");
+
+    return overview_stack;
+}
+
+static GtkWidget *notebook_new(dmi_display_list *dlist, GPtrArray *sections) {
+    GtkWidget *notebook = gtk_notebook_new();
+    gtk_widget_set_hexpand(notebook, TRUE);
+    gtk_widget_set_vexpand(notebook, TRUE);
+
+    gtk_widget_set_can_focus(notebook, FALSE);
+
+    for (guint it = 0; it < dlist->ct; it++) {
+        dmi_display *disp = dmi_display_list_get(dlist, it);
+        g_print("Creating section for display #%u: %p\n", it + 1, (void *)disp);
+
+        DisplaySection *section = display_section_new(disp);
+        if (!section) {
+            g_printerr("Failed to create section for display %u\n", it + 1);
+            continue;
+        }
+
+        g_ptr_array_add(sections, section);
+        if (section->probes_pending > 0) {
+            section->startup = TRUE;
+            sections_probing++;
+        }
+
+        /* Probed sections get the real name once their input is known */
+        const char *current_input_name =
+            disp->cache_primed ? input_name_for_code(display_cached_input(disp)) : "…";
+
+        char display_name[64];
+        snprintf(display_name, sizeof(display_name), "Display %u", it + 1);
+
+        display_section_attach_to_notebook(section, GTK_NOTEBOOK(notebook), display_name,
+                                           current_input_name);
+    }
+
+    return notebook;
+}
+
+static void scale_sync(GtkWidget *scale, GCallback handler, gpointer data, guint16 value) {
+    if (!scale) return;
+
+    /* Blocked, so mirroring the monitor does not write the value straight back */
+    g_signal_handlers_block_by_func(scale, handler, data);
+    gtk_range_set_value(GTK_RANGE(scale), value);
+    g_signal_handlers_unblock_by_func(scale, handler, data);
+}
+
+/* Selects an input switched on the monitor itself, without sending it back */
+static void section_sync_input(DisplaySection *section, int input_code) {
+    if (!section->input_combo || input_code < 0) return;
+
+    if (!section->supported_inputs) {
+        section_show_current_input(section, input_code);
+        return;
+    }
+
+    for (guint i = 0; i < section->supported_inputs->len; i++) {
+        guint idx = g_array_index(section->supported_inputs, guint, i);
+        if (idx >= known_inputs_count || known_inputs[idx].code != input_code) continue;
+
+        g_signal_handlers_block_by_func(section->input_combo, on_input_changed, section);
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(section->input_combo), i);
+        g_signal_handlers_unblock_by_func(section->input_combo, on_input_changed, section);
+        break;
+    }
+    if (section->input_pill) {
+        gtk_label_set_text(GTK_LABEL(section->input_pill), input_name_for_code(input_code));
+    }
+}
+
+static void section_sync_value(DisplaySection *section, guint8 code) {
+    dmi_display *disp = section->wrapper->ddc;
+    dmi_display_values v;
+    dmi_display_snapshot(disp, &v);
+
+    switch (code) {
+    case 0x10:
+        scale_sync(section->brightness_scale, G_CALLBACK(on_brightness_changed), disp,
+                   v.brightness_val);
+        break;
+    case 0x12:
+        if (v.contrast_max > 0) {
+            scale_sync(section->contrast_scale, G_CALLBACK(on_contrast_changed), disp,
+                       v.contrast_val);
+        }
+        break;
+    case 0x62:
+        scale_sync(section->volume_scale, G_CALLBACK(on_volume_changed), disp, v.volume_val);
+        break;
+    case 0x16:
+        scale_sync(section->red_scale, G_CALLBACK(on_rgb_gain_changed), section,
+                   v.red_gain_val);
+        break;
+    case 0x18:
+        scale_sync(section->green_scale, G_CALLBACK(on_rgb_gain_changed), section,
+                   v.green_gain_val);
+        break;
+    case 0x1a:
+        scale_sync(section->blue_scale, G_CALLBACK(on_rgb_gain_changed), section,
+                   v.blue_gain_val);
+        break;
+    case 0x14:
+        for (guint i = 0; i < color_temp_presets_count && section->ctemp_combo; i++) {
+            if (color_temp_presets[i].code != (v.ctemp_val & 0xFF)) continue;
+
+            g_signal_handlers_block_by_func(section->ctemp_combo, on_color_temp_changed, disp);
+            gtk_drop_down_set_selected(GTK_DROP_DOWN(section->ctemp_combo), i);
+            g_signal_handlers_unblock_by_func(section->ctemp_combo, on_color_temp_changed, disp);
+            break;
+        }
+        break;
+    case 0x60:
+        section_sync_input(section, v.input_val);
+        break;
+    default:
+        break;
+    }
+}
+
+/* A feature was changed with the monitor's own buttons */
+static void on_display_synced(dmi_display *disp, guint8 code, gpointer user_data) {
+    DEBUG_PRINT("OSD change on %s: VCP 0x%02x\n", disp->info.model_name, code);
+
+    for (guint i = 0; notebook_sections && i < notebook_sections->len; i++) {
+        DisplaySection *section = g_ptr_array_index(notebook_sections, i);
+        if (section->wrapper && section->wrapper->ddc == disp) section_sync_value(section, code);
+    }
+    if (overview_section && overview_section->wrapper && overview_section->wrapper->ddc == disp) {
+        section_sync_value(overview_section, code);
+    }
+    if (code == 0x10 || code == 0x60) overview_sync_row(disp);
+}
+
+static void on_window_destroy(GtkWidget *window, gpointer user_data) {
+    GPtrArray *sections = user_data;
+
+    dmi_sync_stop();
+    notebook_sections = NULL;
+    g_ptr_array_free(sections, TRUE);
+
+    display_section_free(overview_section);
+    overview_section = NULL;
+    overview_detail = NULL;
+    overview_stack = NULL;
+    overview_store = NULL;
 
     if (close_timeout_id > 0) {
         g_source_remove(close_timeout_id);
         close_timeout_id = 0;
     }
+    if (release_timeout_id > 0) {
+        g_source_remove(release_timeout_id);
+        release_timeout_id = 0;
+    }
 
     main_window = NULL;
 }
 
+static long resident_kib(void) {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) return -1;
+
+    long size, resident;
+    int n = fscanf(fp, "%ld %ld", &size, &resident);
+    fclose(fp);
+
+    return n == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+}
+
+static gboolean release_ui(gpointer data) {
+    release_timeout_id = 0;
+    if (!main_window || gtk_widget_get_visible(main_window)) return G_SOURCE_REMOVE;
+
+    /* Input switches still point into the widget tree; try again once they are done */
+    if (ui_jobs_in_flight > 0) {
+        release_timeout_id = g_timeout_add_seconds(1, release_ui, NULL);
+        return G_SOURCE_REMOVE;
+    }
+
+    long before = resident_kib();
+
+    /* Without a window the application would quit; the displays and caches stay */
+    g_application_hold(g_application_get_default());
+    ui_released = TRUE;
+    gtk_window_destroy(GTK_WINDOW(main_window));
+
+    if (css_provider) {
+        gtk_style_context_remove_provider_for_display(gdk_display_get_default(),
+                                                      GTK_STYLE_PROVIDER(css_provider));
+        g_clear_object(&css_provider);
+    }
+
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+
+    g_print("Released UI after %u s hidden, resident %ld KiB -> %ld KiB\n", release_after_sec,
+            before, resident_kib());
+    return G_SOURCE_REMOVE;
+}
+
+static void on_window_visible_changed(GtkWidget *window, GParamSpec *pspec, gpointer user_data) {
+    if (release_timeout_id > 0) {
+        g_source_remove(release_timeout_id);
+        release_timeout_id = 0;
+    }
+    if (close_timeout_id > 0) {
+        g_source_remove(close_timeout_id);
+        close_timeout_id = 0;
+    }
+
+    if (!gtk_widget_get_visible(window)) {
+        dmi_sync_stop();
+        if (release_after_sec > 0) {
+            release_timeout_id = g_timeout_add_seconds(release_after_sec, release_ui, NULL);
+        }
+    } else if (!dmi_journal_replay_enabled()) {
+        /* A replay must issue exactly the journaled operations */
+        dmi_sync_start(global_dlist, on_display_synced, NULL);
+    }
+}
+
+static void load_settings(void) {
+    char *path = g_build_filename(g_get_user_config_dir(), "dmi-gtk", "settings.ini", NULL);
+    GKeyFile *kf = g_key_file_new();
+
+    if (g_key_file_load_from_file(kf, path, G_KEY_FILE_NONE, NULL) &&
+        g_key_file_has_key(kf, "resident", "release-after-sec", NULL)) {
+        int sec = g_key_file_get_integer(kf, "resident", "release-after-sec", NULL);
+        release_after_sec = MAX(0, sec);
+    }
+
+    g_key_file_free(kf);
+    g_free(path);
+}
+
+/* Every page has its controls; runs that drive the UI can start now */
+static void sections_probed(void) {
+    if (!main_window) return;
+
+    g_print("Controls ready after %.1f ms\n", (g_get_monotonic_time() - ui_build_us) / 1000.0);
+
+    GApplication *app = g_application_get_default();
+    if (dmi_stress_enabled()) {
+        dmi_stress_start(app, main_window);
+    }
+    if (dmi_journal_replay_enabled()) {
+        dmi_journal_replay_start(app, global_dlist);
+    }
+    if (dmi_soak_enabled()) {
+        dmi_soak_start(app, global_dlist);
+    }
+}
+
+static void app_activate(GtkApplication *app, gpointer user_data);
+
+static void on_displays_detected(GObject *source, GAsyncResult *result, gpointer data) {
+    GtkApplication *app = data;
+    GError *error = NULL;
+
+    if (!dmi_display_list_init_finish(result, &error)) {
+        if (g_error_matches(error, DMI_ERROR, DMI_STATUS_TIMEOUT)) {
+            g_printerr("Display detection timed out.\n");
+        }
+        g_error_free(error);
+    }
+
+    displays_detecting = FALSE;
+    displays_detected = TRUE;
+    app_activate(app, NULL);
+    g_application_release(G_APPLICATION(app));
+}
+
 static void app_activate(GtkApplication *app, gpointer user_data) {
 
     if (main_window) {
         toggle_window_visibility();
         return;
     }
+    /* The window opens as soon as detection is done */
+    if (displays_detecting) return;
 
     static gboolean initialized = FALSE;
     if (!initialized) {
+        static dmi_display_list dlist;
 
-        DDCA_Status init_status = ddca_init(NULL, -1, -1);
-        if (init_status != 0) {
-            g_printerr("Failed to initialize DDC library: %d\n", init_status);
-            g_application_quit(G_APPLICATION(app));
+        if (sim_displays > 0) {
+            dmi_sim_list_init(&dlist, sim_displays, sim_latency_ms);
+            dmi_journal_replay_prepare(&dlist);
+        } else if (!displays_detected) {
+            DDCA_Status init_status = ddca_init(NULL, -1, -1);
+            if (init_status != 0) {
+                g_printerr("Failed to initialize DDC library: %d\n", init_status);
+                g_application_quit(G_APPLICATION(app));
+                return;
+            }
+            /* Process-wide, so it is set once here; dmi-api reads back the writes it wants
+             * verified */
+            ddca_enable_verify(FALSE);
+
+            /* On a worker, so the main loop keeps running; activation picks up from here */
+            g_print("Detecting displays...\n");
+            displays_detecting = TRUE;
+            g_application_hold(G_APPLICATION(app));
+            dmi_display_list_init_async(&dlist, FALSE, NULL, on_displays_detected, app);
             return;
         }
-
-        g_print("Detecting displays...\n");
-        static dmi_display_list dlist;
-        dlist = dmi_display_list_init(false);
         global_dlist = &dlist;
 
         if (dlist.ct == 0) {
@@ -645,6 +1592,22 @@ static void app_activate(GtkApplication *app, gpointer user_data) {
         }
 
         g_print("Found %u display(s)\n", dlist.ct);
+        load_settings();
+        if (dmi_soak_enabled()) release_after_sec = DMI_SOAK_RELEASE_SEC;
+        dmi_sched_init();
+        dmi_curve_init(global_dlist);
+        /* Simulated runs must not replace the state a real instance publishes, and have no
+         * hotplug events to watch */
+        if (sim_displays == 0) {
+            dmi_state_init(global_dlist);
+            dmi_display_list_watch(global_dlist);
+        }
+        if (broker) {
+            dmi_broker_start(sim_displays > 0 ? DMI_BROKER_SIM_SOCKET : DMI_BROKER_SOCKET,
+                             global_dlist);
+        }
+        dmi_control_start(sim_displays > 0 ? DMI_CONTROL_SIM_SOCKET : DMI_CONTROL_SOCKET,
+                          on_control_command, app);
         initialized = TRUE;
     }
 
@@ -655,18 +1618,21 @@ static void app_activate(GtkApplication *app, gpointer user_data) {
         return;
     }
 
-    GtkCssProvider *css = gtk_css_provider_new();
-    GError *error = NULL;
-    gtk_css_provider_load_from_path(css, "style.css");
-    if (error) {
-        g_warning("Failed to load CSS: %s", error->message);
-        g_error_free(error);
-    } else {
+    if (ui_released) {
+        g_application_release(G_APPLICATION(app));
+        ui_released = FALSE;
+    }
+
+    /* Parsed again with every rebuild; release_ui drops it with the window */
+    if (!css_provider) {
+        css_provider = gtk_css_provider_new();
+        gtk_css_provider_load_from_path(css_provider, "style.css");
         gtk_style_context_add_provider_for_display(gdk_display_get_default(),
-                                                   GTK_STYLE_PROVIDER(css),
+                                                   GTK_STYLE_PROVIDER(css_provider),
                                                    GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
     }
-    g_object_unref(css);
+
+    ui_build_us = g_get_monotonic_time();
 
     GtkWidget *window = gtk_application_window_new(app);
     gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
@@ -686,63 +1652,183 @@ static void app_activate(GtkApplication *app, gpointer user_data) {
     gtk_widget_set_margin_start(main_box, 20);
     gtk_widget_set_margin_end(main_box, 20);
 
-    GtkWidget *notebook = gtk_notebook_new();
-    gtk_widget_set_hexpand(notebook, TRUE);
-    gtk_widget_set_vexpand(notebook, TRUE);
+    GPtrArray *sections = g_ptr_array_new_with_free_func((GDestroyNotify)display_section_free);
 
-    gtk_widget_set_can_focus(notebook, FALSE);
+    if (dlist->ct > NOTEBOOK_MAX_DISPLAYS) {
+        /* Video walls: one recycled row per visible display instead of a page per display */
+        gtk_box_append(GTK_BOX(main_box), overview_new(dlist));
+    } else {
+        gtk_box_append(GTK_BOX(main_box), notebook_new(dlist, sections));
+    }
 
-    gtk_box_append(GTK_BOX(main_box), notebook);
+    notebook_sections = sections;
+    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), sections);
+    g_signal_connect(window, "notify::visible", G_CALLBACK(on_window_visible_changed), NULL);
 
-    GList *sections = NULL;
+    gtk_window_set_child(GTK_WINDOW(window), main_box);
 
-    for (guint it = 0; it < dlist->ct; it++) {
-        dmi_display *disp = dmi_display_list_get(dlist, it);
-        g_print("Creating section for display #%u: %p\n", it + 1, (void *)disp);
+    main_window = window;
+    dmi_stress_watch_window(window);
 
-        DisplaySection *section = display_section_new(disp);
-        if (!section) {
-            g_printerr("Failed to create section for display %u\n", it + 1);
-            continue;
-        }
+    gtk_window_present(GTK_WINDOW(window));
+    g_print("UI built, resident %ld KiB\n", resident_kib());
 
-        sections = g_list_append(sections, section);
+    if (sections_probing == 0) sections_probed();
+}
 
-        int current_input_code = dmi_display_get_input(disp);
-        const char *current_input_name = "Unknown";
+typedef struct {
+    dmi_control_request *req;
+} ControlShowWait;
 
-        for (size_t i = 0; i < known_inputs_count; i++) {
-            if (known_inputs[i].code == current_input_code) {
-                current_input_name = known_inputs[i].name;
-                break;
-            }
-        }
+static gboolean control_shown_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    ControlShowWait *wait = data;
 
-        char display_name[64];
-        snprintf(display_name, sizeof(display_name), "Display %u", it + 1);
+    dmi_control_reply(g_steal_pointer(&wait->req), "shown");
+    return G_SOURCE_REMOVE;
+}
 
-        display_section_attach_to_notebook(section, GTK_NOTEBOOK(notebook), display_name,
-                                           current_input_name);
+static void control_show_wait_free(gpointer data) {
+    ControlShowWait *wait = data;
+
+    /* The window went away before it drew a frame */
+    if (wait->req) dmi_control_reply(wait->req, "error");
+    g_free(wait);
+}
+
+static void on_control_command(const char *command, dmi_control_request *req,
+                               gpointer user_data) {
+    GApplication *app = user_data;
+    gboolean visible = main_window && gtk_widget_get_visible(main_window);
+
+    if (g_str_equal(command, "quit")) {
+        dmi_control_reply(req, "ok");
+        g_application_quit(app);
+        return;
     }
 
-    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), sections);
+    if (!g_str_equal(command, "activate") && !g_str_equal(command, "toggle")) {
+        dmi_control_reply(req, "error");
+        return;
+    }
 
-    gtk_window_set_child(GTK_WINDOW(window), main_box);
+    if (visible && g_str_equal(command, "toggle")) {
+        toggle_window_visibility();
+        dmi_control_reply(req, "hidden");
+        return;
+    }
 
-    main_window = window;
+    if (visible) {
+        gtk_window_present(GTK_WINDOW(main_window));
+    } else {
+        g_application_activate(app);
+    }
 
-    gtk_window_present(GTK_WINDOW(window));
+    if (!main_window || !gtk_widget_get_visible(main_window)) {
+        dmi_control_reply(req, "error");
+        return;
+    }
+
+    /* Answer once the window is actually on screen, so the caller can time the whole path */
+    ControlShowWait *wait = g_new0(ControlShowWait, 1);
+    wait->req = req;
+    gtk_widget_add_tick_callback(main_window, control_shown_tick, wait, control_show_wait_free);
+}
+
+static gboolean on_dump_journal(gpointer user_data) {
+    GError *error = NULL;
+    char *path = dmi_journal_dump(&error);
+
+    if (path) {
+        g_print("DDC journal written to %s\n", path);
+        g_free(path);
+    } else {
+        g_printerr("Failed to write DDC journal: %s\n", error->message);
+        g_error_free(error);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static gint on_handle_local_options(GApplication *app, GVariantDict *options, gpointer user_data) {
+    if (parse_kind) return dmi_parse_main(parse_kind);
+
+    if (sim_displays < 0 || sim_latency_ms < 0 || stress_seconds < 0 || soak_minutes < 0 ||
+        watchdog_ms < 0 || journal_entries < 0) {
+        g_printerr("Option values must not be negative\n");
+        return EXIT_FAILURE;
+    }
+
+    if ((replay_path != NULL) + (stress_seconds > 0) + (soak_minutes > 0) > 1) {
+        g_printerr("--replay, --stress and --soak cannot be combined\n");
+        return EXIT_FAILURE;
+    }
+
+    if (replay_path) {
+
+        guint n = dmi_journal_replay_load(replay_path);
+        if (n == 0) return EXIT_FAILURE;
+
+        /* The journal supplies every transaction's duration */
+        sim_displays = n;
+        sim_latency_ms = 0;
+    }
+
+    if (journal_entries > 0) {
+        dmi_journal_start(journal_entries);
+        g_unix_signal_add(SIGUSR2, on_dump_journal, NULL);
+    }
+
+    if (stress_seconds > 0) {
+        if (sim_displays == 0) sim_displays = SIM_DEFAULT_DISPLAYS;
+        dmi_stress_init(stress_seconds);
+    }
+
+    if (soak_minutes > 0) {
+        if (soak_minutes < DMI_SOAK_MIN_MINUTES) {
+            g_printerr("--soak needs at least %d minutes\n", DMI_SOAK_MIN_MINUTES);
+            return EXIT_FAILURE;
+        }
+        if (sim_displays == 0) sim_displays = SIM_DEFAULT_DISPLAYS;
+        dmi_soak_init(soak_minutes);
+    }
+
+    /* Simulated and stress runs must not hand off to, or take over from, a real instance */
+    if (sim_displays > 0) {
+        g_application_set_flags(app, g_application_get_flags(app) | G_APPLICATION_NON_UNIQUE);
+    }
+
+    dmi_watchdog_start(watchdog_ms);
+    if (count_wakeups) dmi_watchdog_count_wakeups(WAKEUP_REPORT_SEC);
+
+    return -1;
 }
 
 int main(int argc, char **argv) {
+    dmi_soak_reexec(argc, argv);
 
     GtkApplication *app = gtk_application_new("com.github.dmi-gtk", G_APPLICATION_DEFAULT_FLAGS);
 
+    g_application_add_main_option_entries(G_APPLICATION(app), option_entries);
+    g_signal_connect(app, "handle-local-options", G_CALLBACK(on_handle_local_options), NULL);
     g_signal_connect(app, "activate", G_CALLBACK(app_activate), NULL);
 
     int status = g_application_run(G_APPLICATION(app), argc, argv);
+    dmi_watchdog_stop();
+    if (status == 0 && dmi_stress_enabled()) {
+        status = dmi_stress_status();
+    }
+    if (status == 0 && dmi_journal_replay_enabled()) {
+        status = dmi_journal_replay_status();
+    }
+    if (status == 0 && dmi_soak_enabled()) {
+        status = dmi_soak_status();
+    }
 
     g_object_unref(app);
+    dmi_control_stop();
+    dmi_broker_stop();
+    dmi_state_shutdown();
+    dmi_curve_shutdown();
+    dmi_sched_shutdown();
     if (global_dlist) {
         dmi_display_list_free(global_dlist);
     }